@@ -0,0 +1,118 @@
+#ifndef netlists_h
+#define netlists_h
+
+#include "backend/circuit/parsedCircuit.h"
+
+// Synthetic circuits for the simulator benchmarks. Everything is built as a ParsedCircuit so a whole
+// netlist reaches the evaluator as a single edit. Primitive blocks use connection end 0 as their
+// input and 1 as their output.
+class NetlistBuilder {
+public:
+	block_id_t addBlock(BlockType type) {
+		block_id_t id = nextId++;
+		parsedCircuit.addBlock(id, FPosition(id % rowWidth, id / rowWidth), Orientation(), type);
+		return id;
+	}
+	void connect(block_id_t output, block_id_t input) {
+		parsedCircuit.addConnection(output, 1, input, 0);
+	}
+	block_id_t addGate(BlockType type, std::initializer_list<block_id_t> inputs) {
+		block_id_t id = addBlock(type);
+		for (block_id_t input : inputs) connect(input, id);
+		return id;
+	}
+	// switches the benchmarks flip between batches of ticks to keep the circuit active
+	block_id_t addStimulus() {
+		block_id_t id = addBlock(BlockType::SWITCH);
+		stimuli.push_back(id);
+		return id;
+	}
+
+	const ParsedCircuit& getParsedCircuit() const { return parsedCircuit; }
+	// positions of the stimulus switches once the circuit is inserted at (0, 0)
+	std::vector<Position> getStimulusPositions() const {
+		std::vector<Position> positions;
+		for (block_id_t id : stimuli) positions.push_back(Position(id % rowWidth, id / rowWidth));
+		return positions;
+	}
+
+private:
+	static constexpr block_id_t rowWidth = 256;
+
+	ParsedCircuit parsedCircuit;
+	std::vector<block_id_t> stimuli;
+	block_id_t nextId = 0;
+};
+
+// bits wide ripple carry adder with switch inputs
+inline void buildRippleAdder(NetlistBuilder& builder, unsigned int bits) {
+	block_id_t carry = builder.addStimulus();
+	for (unsigned int i = 0; i < bits; ++i) {
+		block_id_t a = builder.addStimulus();
+		block_id_t b = builder.addStimulus();
+		block_id_t halfSum = builder.addGate(BlockType::XOR, { a, b });
+		builder.addGate(BlockType::XOR, { halfSum, carry });
+		block_id_t carryA = builder.addGate(BlockType::AND, { a, b });
+		block_id_t carryB = builder.addGate(BlockType::AND, { halfSum, carry });
+		carry = builder.addGate(BlockType::OR, { carryA, carryB });
+	}
+}
+
+// count free running LFSRs, a ring of buffers with an XNOR feedback tap so they start from all low
+inline void buildLfsrBank(NetlistBuilder& builder, unsigned int count, unsigned int width) {
+	for (unsigned int lfsr = 0; lfsr < count; ++lfsr) {
+		block_id_t feedback = builder.addBlock(BlockType::XNOR);
+		block_id_t previous = feedback;
+		std::vector<block_id_t> stages;
+		for (unsigned int i = 0; i < width; ++i) {
+			previous = builder.addGate(BlockType::OR, { previous });
+			stages.push_back(previous);
+		}
+		builder.connect(stages[width - 1], feedback);
+		builder.connect(stages[width - 3], feedback);
+	}
+}
+
+// words x bits NOR latch array with per word write enables and an OR read bus per bit
+inline void buildSramArray(NetlistBuilder& builder, unsigned int words, unsigned int bits) {
+	std::vector<block_id_t> data;
+	std::vector<block_id_t> dataInverted;
+	std::vector<block_id_t> readBus;
+	for (unsigned int bit = 0; bit < bits; ++bit) {
+		data.push_back(builder.addStimulus());
+		dataInverted.push_back(builder.addGate(BlockType::NOR, { data.back() }));
+		readBus.push_back(builder.addBlock(BlockType::OR));
+	}
+	for (unsigned int word = 0; word < words; ++word) {
+		block_id_t wordLine = builder.addStimulus();
+		for (unsigned int bit = 0; bit < bits; ++bit) {
+			block_id_t set = builder.addGate(BlockType::AND, { wordLine, data[bit] });
+			block_id_t reset = builder.addGate(BlockType::AND, { wordLine, dataInverted[bit] });
+			block_id_t q = builder.addGate(BlockType::NOR, { reset });
+			block_id_t qInverted = builder.addGate(BlockType::NOR, { set, q });
+			builder.connect(qInverted, q);
+			block_id_t read = builder.addGate(BlockType::AND, { q, wordLine });
+			builder.connect(read, readBus[bit]);
+		}
+	}
+}
+
+// depth layers of width junctions, each junction joined to two junctions of the previous layer
+inline void buildJunctionMesh(NetlistBuilder& builder, unsigned int width, unsigned int depth) {
+	std::vector<block_id_t> layer;
+	for (unsigned int i = 0; i < width; ++i) {
+		layer.push_back(builder.addGate(BlockType::JUNCTION, { builder.addStimulus() }));
+	}
+	for (unsigned int d = 1; d < depth; ++d) {
+		std::vector<block_id_t> nextLayer;
+		for (unsigned int i = 0; i < width; ++i) {
+			nextLayer.push_back(builder.addGate(BlockType::JUNCTION, { layer[i], layer[(i + 1) % width] }));
+		}
+		layer = std::move(nextLayer);
+	}
+	for (unsigned int i = 0; i < width; ++i) {
+		builder.addGate(BlockType::NOR, { layer[i] });
+	}
+}
+
+#endif /* netlists_h */
@@ -0,0 +1,172 @@
+#include <benchmark/benchmark.h>
+
+#include "backend/backend.h"
+#include "computerAPI/circuits/circuitFileManager.h"
+#include "netlists.h"
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+// Simulator throughput benchmarks. Every benchmark takes the evaluation mode
+// (0 full, 1 event driven, 2 levelized) and the simulator thread count as its last two arguments
+// (after the size for the synthetic circuits) and reports:
+//   ticks/s        simulated ticks per second
+//   gateEvals      time per gate per tick (inverted rate, so lower is better)
+//   bytes/gate     resident memory added by loading the circuit and creating the evaluator
+//
+// The CircuitLib benchmarks look for the files in CIRCUIT_LIB_DIR (set by cmake).
+
+namespace {
+
+// resident set size, 0 where we do not know how to read it
+size_t residentBytes() {
+#if defined(__linux__)
+	std::ifstream statm("/proc/self/statm");
+	size_t totalPages = 0;
+	size_t residentPages = 0;
+	statm >> totalPages >> residentPages;
+	return residentPages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+	return 0;
+#endif
+}
+
+// same setup as App, the backend only stores the file manager pointer
+struct Environment {
+	Environment() : backend(&circuitFileManager), circuitFileManager(&(backend.getCircuitManager())) { }
+
+	Backend backend;
+	CircuitFileManager circuitFileManager;
+	SharedCircuit circuit;
+	SharedEvaluator evaluator;
+	std::vector<Position> stimuli;
+	size_t bytesPerGate = 0;
+
+	// the mode and thread count are arguments modeArg and modeArg + 1
+	bool createEvaluator(benchmark::State& state, size_t modeArg, size_t residentBefore) {
+		std::optional<evaluator_id_t> evaluatorId = backend.createEvaluator(circuit->getCircuitId());
+		if (!evaluatorId) {
+			state.SkipWithError("could not create an evaluator");
+			return false;
+		}
+		evaluator = backend.getEvaluator(evaluatorId.value());
+		evaluator->setUseTickrate(false);
+		evaluator->setEvaluationMode(static_cast<EvaluationMode>(state.range(modeArg)));
+		evaluator->setThreadCount(static_cast<unsigned int>(state.range(modeArg + 1)));
+		size_t residentAfter = residentBytes();
+		size_t gateCount = std::max<size_t>(circuit->getBlockContainer()->getBlockCount(), 1);
+		bytesPerGate = residentAfter > residentBefore ? (residentAfter - residentBefore) / gateCount : 0;
+		return true;
+	}
+
+	bool build(benchmark::State& state, const NetlistBuilder& builder) {
+		size_t residentBefore = residentBytes();
+		circuit = backend.getCircuit(backend.createCircuit());
+		if (!circuit->tryInsertParsedCircuit(builder.getParsedCircuit(), Position(0, 0))) {
+			state.SkipWithError("could not insert the netlist");
+			return false;
+		}
+		stimuli = builder.getStimulusPositions();
+		return createEvaluator(state, 1, residentBefore);
+	}
+
+	bool load(benchmark::State& state, const std::string& fileName) {
+		size_t residentBefore = residentBytes();
+		std::vector<circuit_id_t> circuitIds = circuitFileManager.loadFromFile(std::string(CIRCUIT_LIB_DIR) + "/" + fileName);
+		if (circuitIds.empty() || circuitIds.back() == 0) {
+			state.SkipWithError("could not load the circuit");
+			return false;
+		}
+		circuit = backend.getCircuit(circuitIds.back());
+		return createEvaluator(state, 0, residentBefore);
+	}
+};
+
+// every tickStep also pauses the simulator and rebuilds its jobs, large batches keep that out of ticks/s
+constexpr unsigned int ticksPerBatch = 20000;
+
+void runTicks(benchmark::State& state, Environment& environment) {
+	size_t gateCount = environment.circuit->getBlockContainer()->getBlockCount();
+	unsigned long long ticks = 0;
+	bool stimulusState = false;
+	for (auto _ : state) {
+		// flip the inputs between batches so event driven evaluation has work to do
+		stimulusState = !stimulusState;
+		for (Position position : environment.stimuli) {
+			environment.evaluator->setState(Address(position), stimulusState);
+		}
+		environment.evaluator->tickStep(ticksPerBatch);
+		ticks += ticksPerBatch;
+	}
+	state.counters["ticks/s"] = benchmark::Counter(static_cast<double>(ticks), benchmark::Counter::kIsRate);
+	state.counters["gateEvals"] = benchmark::Counter(static_cast<double>(ticks * gateCount), benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+	state.counters["gates"] = static_cast<double>(gateCount);
+	state.counters["bytes/gate"] = static_cast<double>(environment.bytesPerGate);
+}
+
+void BM_RippleAdder(benchmark::State& state) {
+	NetlistBuilder builder;
+	buildRippleAdder(builder, static_cast<unsigned int>(state.range(0)));
+	Environment environment;
+	if (environment.build(state, builder)) runTicks(state, environment);
+}
+
+void BM_LfsrBank(benchmark::State& state) {
+	NetlistBuilder builder;
+	buildLfsrBank(builder, static_cast<unsigned int>(state.range(0)), 32);
+	Environment environment;
+	if (environment.build(state, builder)) runTicks(state, environment);
+}
+
+void BM_SramArray(benchmark::State& state) {
+	NetlistBuilder builder;
+	buildSramArray(builder, static_cast<unsigned int>(state.range(0)), 32);
+	Environment environment;
+	if (environment.build(state, builder)) runTicks(state, environment);
+}
+
+void BM_JunctionMesh(benchmark::State& state) {
+	NetlistBuilder builder;
+	buildJunctionMesh(builder, 64, static_cast<unsigned int>(state.range(0)));
+	Environment environment;
+	if (environment.build(state, builder)) runTicks(state, environment);
+}
+
+void BM_CircuitLib(benchmark::State& state, const char* fileName) {
+	Environment environment;
+	if (environment.load(state, fileName)) runTicks(state, environment);
+}
+
+// time to place a gate, wire it into the circuit and remove it again
+void BM_EditLatency(benchmark::State& state) {
+	NetlistBuilder builder;
+	buildLfsrBank(builder, static_cast<unsigned int>(state.range(0)), 32);
+	Environment environment;
+	if (!environment.build(state, builder)) return;
+	Position source(0, 0);
+	Position position(-2, -2);
+	for (auto _ : state) {
+		environment.circuit->tryInsertBlock(position, Rotation::ZERO, BlockType::AND);
+		environment.circuit->tryCreateConnection(source, position);
+		environment.circuit->tryRemoveBlock(position);
+	}
+	state.counters["edits"] = benchmark::Counter(static_cast<double>(state.iterations() * 3), benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+// {evaluation mode} x {thread count}
+const std::vector<int64_t> modes = { 0, 1, 2 };
+const std::vector<int64_t> threadCounts = { 1, 2, 4, 8 };
+
+} // namespace
+
+BENCHMARK(BM_RippleAdder)->ArgsProduct({ { 64, 1024 }, modes, threadCounts })->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LfsrBank)->ArgsProduct({ { 16, 512 }, modes, threadCounts })->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SramArray)->ArgsProduct({ { 16, 256 }, modes, threadCounts })->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_JunctionMesh)->ArgsProduct({ { 8, 64 }, modes, threadCounts })->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_CircuitLib, CPU2, "CPU2.cir")->ArgsProduct({ modes, threadCounts })->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_CircuitLib, flappy_bird, "flappy_bird.cir")->ArgsProduct({ modes, threadCounts })->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_CircuitLib, UART_demo, "UART_demo.cir")->ArgsProduct({ modes, threadCounts })->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_EditLatency)->ArgsProduct({ { 16, 512 }, modes, threadCounts })->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,277 @@
+#include "backend/backend.h"
+#include "computerAPI/circuits/circuitFileManager.h"
+
+// Headless simulation runner. Loads a circuit, applies a stimulus file, runs the evaluator with the
+// tickrate limiter off and writes the port values and the throughput.
+//
+// Stimulus file, one change per line, blank lines and lines starting with # are ignored:
+//     <tick> <port name or x,y> <0|1>
+// Changes are applied once the simulation reaches <tick>.
+
+struct Port {
+	std::string name;
+	Position position;
+	bool isInput;
+};
+
+struct Stimulus {
+	unsigned long long tick;
+	Position position;
+	bool state;
+};
+
+// same setup as App, the backend only stores the file manager pointer
+struct Environment {
+	Environment() : backend(&circuitFileManager), circuitFileManager(&(backend.getCircuitManager())) { }
+
+	Backend backend;
+	CircuitFileManager circuitFileManager;
+};
+
+struct Options {
+	std::string circuitPath;
+	std::string stimulusPath;
+	std::string outputPath;
+	unsigned long long ticks = 1000;
+	unsigned long long sampleInterval = 0;
+	EvaluationMode evaluationMode = EvaluationMode::FULL;
+	unsigned int threadCount = 0;
+	bool realistic = false;
+};
+
+void printUsage() {
+	std::cerr << "usage: Connection_Machine_cli <circuit file> [options]\n"
+		<< "  --ticks <n>          number of ticks to run (default 1000)\n"
+		<< "  --stimulus <file>    input changes, lines of \"<tick> <port|x,y> <0|1>\"\n"
+		<< "  --output <file>      write results to a file instead of stdout\n"
+		<< "  --sample <n>         write the port values every n ticks instead of only at the end\n"
+		<< "  --mode <mode>        full, event or levelized (default full)\n"
+		<< "  --threads <n>        simulator threads, 0 picks from the hardware (default 0)\n"
+		<< "  --realistic          use realistic evaluation\n";
+}
+
+// reads the whole text as a count that fits in T, std::stoull alone would wrap "-1" around
+template<typename T>
+bool parseCount(const std::string& option, const std::string& text, T& count) {
+	if (!text.empty() && text.find_first_not_of("0123456789") == std::string::npos) {
+		try {
+			unsigned long long value = std::stoull(text);
+			if (value <= std::numeric_limits<T>::max()) {
+				count = static_cast<T>(value);
+				return true;
+			}
+		} catch (const std::out_of_range&) { }
+	}
+	std::cerr << "invalid value \"" << text << "\" for " << option << "\n";
+	return false;
+}
+
+std::optional<Options> parseOptions(int argc, char* argv[]) {
+	Options options;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--ticks" && hasValue) {
+			if (!parseCount(arg, argv[++i], options.ticks)) return std::nullopt;
+		} else if (arg == "--stimulus" && hasValue) {
+			options.stimulusPath = argv[++i];
+		} else if (arg == "--output" && hasValue) {
+			options.outputPath = argv[++i];
+		} else if (arg == "--sample" && hasValue) {
+			if (!parseCount(arg, argv[++i], options.sampleInterval)) return std::nullopt;
+		} else if (arg == "--threads" && hasValue) {
+			if (!parseCount(arg, argv[++i], options.threadCount)) return std::nullopt;
+		} else if (arg == "--mode" && hasValue) {
+			std::string mode = argv[++i];
+			if (mode == "full") {
+				options.evaluationMode = EvaluationMode::FULL;
+			} else if (mode == "event") {
+				options.evaluationMode = EvaluationMode::EVENT_DRIVEN;
+			} else if (mode == "levelized") {
+				options.evaluationMode = EvaluationMode::LEVELIZED;
+			} else {
+				std::cerr << "unknown mode \"" << mode << "\"\n";
+				return std::nullopt;
+			}
+		} else if (arg == "--realistic") {
+			options.realistic = true;
+		} else if (!arg.starts_with("--") && options.circuitPath.empty()) {
+			options.circuitPath = arg;
+		} else {
+			std::cerr << "unknown argument \"" << arg << "\"\n";
+			return std::nullopt;
+		}
+	}
+	if (options.circuitPath.empty()) return std::nullopt;
+	return options;
+}
+
+// the IO of the circuit, taken from the block data of the circuit's own block type
+std::vector<Port> getPorts(Backend& backend, const Circuit& circuit) {
+	std::vector<Port> ports;
+	const BlockData* blockData = backend.getBlockDataManager()->getBlockData(circuit.getBlockType());
+	const CircuitBlockData* circuitBlockData = backend.getCircuitManager().getCircuitBlockDataManager()->getCircuitBlockData(circuit.getCircuitId());
+	if (!blockData || !circuitBlockData || blockData->isDefaultData()) return ports;
+	for (const auto& [endId, connection] : blockData->getConnections()) {
+		const Position* position = circuitBlockData->getConnectionIdToPosition(endId);
+		if (!position) continue;
+		bool isInput = connection.second;
+		const std::string* name = blockData->getConnectionIdToName(endId);
+		ports.push_back({ name ? *name : (isInput ? "in" : "out") + std::to_string(endId), *position, isInput });
+	}
+	std::sort(ports.begin(), ports.end(), [](const Port& a, const Port& b) {
+		return a.isInput != b.isInput ? a.isInput : a.name < b.name;
+	});
+	return ports;
+}
+
+std::optional<Position> parsePortOrPosition(const std::string& text, const std::vector<Port>& ports) {
+	for (const Port& port : ports) {
+		if (port.name == text) return port.position;
+	}
+	size_t comma = text.find(',');
+	if (comma == std::string::npos) return std::nullopt;
+	try {
+		return Position(std::stoi(text.substr(0, comma)), std::stoi(text.substr(comma + 1)));
+	} catch (const std::exception&) {
+		return std::nullopt;
+	}
+}
+
+std::optional<std::vector<Stimulus>> loadStimulus(const std::string& path, const std::vector<Port>& ports) {
+	std::ifstream file(path);
+	if (!file.is_open()) {
+		logError("Could not open stimulus file {}", "Connection_Machine_cli", path);
+		return std::nullopt;
+	}
+	std::vector<Stimulus> stimuli;
+	std::string line;
+	unsigned int lineNumber = 0;
+	while (std::getline(file, line)) {
+		++lineNumber;
+		if (line.empty() || line[0] == '#') continue;
+		std::istringstream lineStream(line);
+		unsigned long long tick;
+		std::string target;
+		int state;
+		if (!(lineStream >> tick >> target >> state)) {
+			logError("Could not parse line {} of {}", "Connection_Machine_cli", lineNumber, path);
+			return std::nullopt;
+		}
+		std::optional<Position> position = parsePortOrPosition(target, ports);
+		if (!position) {
+			logError("Unknown port \"{}\" on line {} of {}", "Connection_Machine_cli", target, lineNumber, path);
+			return std::nullopt;
+		}
+		stimuli.push_back({ tick, *position, state != 0 });
+	}
+	std::stable_sort(stimuli.begin(), stimuli.end(), [](const Stimulus& a, const Stimulus& b) { return a.tick < b.tick; });
+	return stimuli;
+}
+
+char stateToChar(logic_state_t state) {
+	switch (state) {
+	case logic_state_t::LOW: return '0';
+	case logic_state_t::HIGH: return '1';
+	case logic_state_t::FLOATING: return 'Z';
+	default: return 'X';
+	}
+}
+
+void writeSample(std::ostream& out, unsigned long long tick, Evaluator& evaluator, const std::vector<Port>& ports) {
+	out << tick;
+	for (const Port& port : ports) {
+		out << ',' << stateToChar(evaluator.getState(Address(port.position)));
+	}
+	out << '\n';
+}
+
+int main(int argc, char* argv[]) {
+	std::optional<Options> options = parseOptions(argc, argv);
+	if (!options) {
+		printUsage();
+		return EXIT_FAILURE;
+	}
+
+	try {
+		Environment environment;
+		Backend& backend = environment.backend;
+		CircuitFileManager& circuitFileManager = environment.circuitFileManager;
+
+		std::vector<circuit_id_t> circuitIds = circuitFileManager.loadFromFile(options->circuitPath);
+		if (circuitIds.empty() || circuitIds.back() == 0) {
+			logError("Failed to load circuit file {}", "Connection_Machine_cli", options->circuitPath);
+			return EXIT_FAILURE;
+		}
+		SharedCircuit circuit = backend.getCircuit(circuitIds.back());
+		std::optional<evaluator_id_t> evaluatorId = backend.createEvaluator(circuit->getCircuitId());
+		if (!evaluatorId) {
+			logError("Failed to create an evaluator for {}", "Connection_Machine_cli", circuit->getCircuitName());
+			return EXIT_FAILURE;
+		}
+		SharedEvaluator evaluator = backend.getEvaluator(evaluatorId.value());
+		evaluator->setUseTickrate(false);
+		evaluator->setRealistic(options->realistic);
+		evaluator->setEvaluationMode(options->evaluationMode);
+		evaluator->setThreadCount(options->threadCount);
+
+		std::vector<Port> ports = getPorts(backend, *circuit);
+		std::vector<Stimulus> stimuli;
+		if (!options->stimulusPath.empty()) {
+			std::optional<std::vector<Stimulus>> loaded = loadStimulus(options->stimulusPath, ports);
+			if (!loaded) return EXIT_FAILURE;
+			stimuli = std::move(loaded.value());
+		}
+
+		std::ofstream outputFile;
+		if (!options->outputPath.empty()) {
+			outputFile.open(options->outputPath);
+			if (!outputFile.is_open()) {
+				logError("Could not open output file {}", "Connection_Machine_cli", options->outputPath);
+				return EXIT_FAILURE;
+			}
+		}
+		std::ostream& out = options->outputPath.empty() ? std::cout : outputFile;
+
+		out << "tick";
+		for (const Port& port : ports) out << ',' << port.name;
+		out << '\n';
+
+		// run until the next stimulus or sample, only time spent ticking counts towards the throughput
+		std::chrono::steady_clock::duration tickTime(0);
+		size_t nextStimulus = 0;
+		unsigned long long tick = 0;
+		while (true) {
+			for (; nextStimulus < stimuli.size() && stimuli[nextStimulus].tick <= tick; ++nextStimulus) {
+				evaluator->setState(Address(stimuli[nextStimulus].position), stimuli[nextStimulus].state);
+			}
+			if (tick == options->ticks) break;
+
+			unsigned long long nextTick = options->ticks;
+			if (nextStimulus < stimuli.size()) nextTick = std::min(nextTick, stimuli[nextStimulus].tick);
+			if (options->sampleInterval != 0) nextTick = std::min(nextTick, (tick / options->sampleInterval + 1) * options->sampleInterval);
+
+			auto start = std::chrono::steady_clock::now();
+			// the sprint counter is an int, longer runs go in several steps
+			for (unsigned long long remaining = nextTick - tick; remaining != 0;) {
+				unsigned int step = static_cast<unsigned int>(std::min<unsigned long long>(remaining, std::numeric_limits<int>::max()));
+				evaluator->tickStep(step);
+				remaining -= step;
+			}
+			tickTime += std::chrono::steady_clock::now() - start;
+			tick = nextTick;
+
+			if (options->sampleInterval != 0 && tick % options->sampleInterval == 0 && tick != options->ticks) {
+				writeSample(out, tick, *evaluator, ports);
+			}
+		}
+		writeSample(out, tick, *evaluator, ports);
+
+		double seconds = std::chrono::duration<double>(tickTime).count();
+		out << "# ticks " << tick << " seconds " << seconds << " ticks/s " << (seconds > 0.0 ? tick / seconds : 0.0) << '\n';
+	} catch (const std::exception& e) {
+		logFatalError("Exiting Connection_Machine_cli because of fatal error: '{}'", "", e.what());
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
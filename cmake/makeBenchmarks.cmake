@@ -0,0 +1,40 @@
+# ===================================== CREATE BENCHMARK EXECUTABLE ========================================
+
+# Google Benchmark
+CPMAddPackage(
+	NAME benchmark
+	GITHUB_REPOSITORY google/benchmark
+	GIT_TAG v1.9.4
+	SOURCE_DIR "${EXTERNAL_DIR}/benchmark"
+	OPTIONS
+		"BENCHMARK_ENABLE_TESTING OFF"
+		"BENCHMARK_ENABLE_GTEST_TESTS OFF"
+		"BENCHMARK_ENABLE_INSTALL OFF"
+)
+
+set(BENCHMARK_DIR "${CMAKE_SOURCE_DIR}/benchmarks")
+set(BENCHMARK_FILES)
+file(GLOB_RECURSE BENCHMARK_FILES
+	"${SOURCE_DIR}/backend/*.cpp"
+	"${SOURCE_DIR}/computerAPI/*.cpp"
+	"${SOURCE_DIR}/logging/*.cpp"
+	"${SOURCE_DIR}/util/*.cpp"
+	"${BENCHMARK_DIR}/*.cpp"
+)
+
+set(EXTERNAL_LINKS ${EXTERNAL_LINKS} benchmark::benchmark)
+
+if(APPLE)
+	# Link CoreFoundation explicitly on macOS
+	list(APPEND EXTERNAL_LINKS "-framework CoreFoundation")
+endif()
+
+add_executable(${PROJECT_NAME}_benchmarks ${BENCHMARK_FILES})
+
+add_main_dependencies()
+
+target_include_directories(${PROJECT_NAME}_benchmarks PRIVATE ${SOURCE_DIR} ${BENCHMARK_DIR} "${EXTERNAL_DIR}/wasmtime")
+target_link_libraries(${PROJECT_NAME}_benchmarks PRIVATE ${EXTERNAL_LINKS})
+target_compile_definitions(${PROJECT_NAME}_benchmarks PRIVATE CIRCUIT_LIB_DIR="${CMAKE_SOURCE_DIR}/CircuitLib")
+
+target_precompile_headers(${PROJECT_NAME}_benchmarks PRIVATE "${SOURCE_DIR}/precompiled.h")
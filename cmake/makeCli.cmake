@@ -0,0 +1,26 @@
+# ===================================== CREATE CLI EXECUTABLE ========================================
+# Headless runner for CI, only the backend without the GUI and its SDL/Vulkan dependencies
+
+set(CLI_DIR "${CMAKE_SOURCE_DIR}/cli")
+set(CLI_FILES)
+file(GLOB_RECURSE CLI_FILES
+	"${SOURCE_DIR}/backend/*.cpp"
+	"${SOURCE_DIR}/computerAPI/*.cpp"
+	"${SOURCE_DIR}/logging/*.cpp"
+	"${SOURCE_DIR}/util/*.cpp"
+	"${CLI_DIR}/*.cpp"
+)
+
+if(APPLE)
+	# Link CoreFoundation explicitly on macOS
+	list(APPEND EXTERNAL_LINKS "-framework CoreFoundation")
+endif()
+
+add_executable(${PROJECT_NAME}_cli ${CLI_FILES})
+
+add_main_dependencies()
+
+target_include_directories(${PROJECT_NAME}_cli PRIVATE ${SOURCE_DIR} "${EXTERNAL_DIR}/wasmtime")
+target_link_libraries(${PROJECT_NAME}_cli PRIVATE ${EXTERNAL_LINKS})
+
+target_precompile_headers(${PROJECT_NAME}_cli PRIVATE "${SOURCE_DIR}/precompiled.h")
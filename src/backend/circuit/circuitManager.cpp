@@ -63,6 +63,8 @@ circuit_id_t CircuitManager::createNewCircuit(const ParsedCircuit* parsedCircuit
 
 	circuit_id_t id = createNewCircuit(parsedCircuit->getName(), uuid, createEval);
 	SharedCircuit circuit = getCircuit(id);
+	// the blocks and the IO positions reach the evaluators as one edit
+	EvaluatorEditBatch editBatch(evaluatorManager);
 	circuit->tryInsertParsedCircuit(*parsedCircuit, Position());
 
 	// if is custom
@@ -127,6 +129,7 @@ circuit_id_t CircuitManager::createNewCircuit(const GeneratedCircuit* generatedC
 	std::string uuid = generate_uuid_v4();
 	circuit_id_t id = createNewCircuit(generatedCircuit->getName(), uuid, createEval);
 	SharedCircuit circuit = getCircuit(id);
+	EvaluatorEditBatch editBatch(evaluatorManager);
 	circuit->tryInsertGeneratedCircuit(*generatedCircuit, Position());
 
 	if (!generatedCircuit->isCustom()) {
@@ -192,6 +195,8 @@ void CircuitManager::updateExistingCircuit(circuit_id_t id, const GeneratedCircu
 	SharedCircuit circuit = getCircuit(id);
 	std::string uuid = circuit->getUUID();
 
+	// clearing and regenerating reaches the evaluators as one edit
+	EvaluatorEditBatch editBatch(evaluatorManager);
 	circuit->clear(true);
 
 	circuit->tryInsertGeneratedCircuit(*generatedCircuit, Position());
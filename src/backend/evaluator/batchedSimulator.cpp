@@ -0,0 +1,255 @@
+#include "batchedSimulator.h"
+#include "logicSimulator.h"
+
+namespace {
+	typedef BatchedSimulator::lane_word_t lane_word_t;
+
+	constexpr lane_word_t allLanes = ~lane_word_t(0);
+
+	inline lane_word_t broadcast(bool bit) {
+		return bit ? allLanes : 0;
+	}
+
+	// lane wise resolveSeenDrivers over one word of every driver
+	inline void resolveDrivers(
+		const simulator_id_t* begin, const simulator_id_t* end, const lane_word_t* states,
+		size_t stride, size_t laneWords, unsigned int word, lane_word_t& value, lane_word_t& invalid
+	) {
+		lane_word_t seenLow = 0;
+		lane_word_t seenHigh = 0;
+		lane_word_t seenUndefined = 0;
+		for (const simulator_id_t* it = begin; it != end; ++it) {
+			const lane_word_t v = states[*it * stride + word];
+			const lane_word_t x = states[*it * stride + laneWords + word];
+			seenLow |= ~v & ~x;
+			seenHigh |= v & ~x;
+			seenUndefined |= v & x;
+		}
+		const lane_word_t undefined = seenUndefined | (seenLow & seenHigh);
+		value = undefined | seenHigh;
+		invalid = undefined | (~seenHigh & ~seenLow);
+	}
+}
+
+BatchedSimulator::BatchedSimulator(const LogicSimulator& simulator, unsigned int laneCount, bool realistic) :
+	laneCount(laneCount),
+	laneWords((laneCount + lanesPerWord - 1) / lanesPerWord),
+	stride(2 * static_cast<size_t>(laneWords)),
+	idCount(simulator.statesA.size()),
+	realistic(realistic) {
+	statesA.assign(idCount * stride, 0);
+	for (simulator_id_t id = 0; id < idCount; ++id) {
+		fillState(id, simulator.statesA[id]);
+	}
+	statesB = statesA;
+
+	simulator.compileGateLists(andGates, xorGates, junctions, tristateBuffers);
+	for (const auto& gate : simulator.constantResetGates) {
+		constantResetIds.push_back(gate.getId());
+		constantResetStates.push_back(gate.calculate());
+	}
+	for (const auto& gate : simulator.copySelfOutputGates) {
+		copySelfOutputIds.push_back(gate.getId());
+	}
+	for (const auto& gate : simulator.buffers) {
+		delayGates.push_back({ gate.getId(), gate.getInput(), gate.outputInverted, gate.extraDelayTicks, gate.delayHead, delayLines.size() });
+		for (logic_state_t state : gate.delayLine) {
+			delayLines.insert(delayLines.end(), laneWords, broadcast(static_cast<unsigned int>(state) & 1u));
+			delayLines.insert(delayLines.end(), laneWords, broadcast(static_cast<unsigned int>(state) & 2u));
+		}
+	}
+}
+
+void BatchedSimulator::fillState(simulator_id_t id, logic_state_t state) {
+	std::fill_n(valuePlane(statesA, id), laneWords, broadcast(static_cast<unsigned int>(state) & 1u));
+	std::fill_n(invalidPlane(statesA, id), laneWords, broadcast(static_cast<unsigned int>(state) & 2u));
+}
+
+void BatchedSimulator::writeState(std::vector<lane_word_t>& states, unsigned int lane, simulator_id_t id, logic_state_t state) {
+	const unsigned int word = lane / lanesPerWord;
+	const lane_word_t bit = lane_word_t(1) << (lane % lanesPerWord);
+	lane_word_t& value = valuePlane(states, id)[word];
+	lane_word_t& invalid = invalidPlane(states, id)[word];
+	value = (static_cast<unsigned int>(state) & 1u) ? value | bit : value & ~bit;
+	invalid = (static_cast<unsigned int>(state) & 2u) ? invalid | bit : invalid & ~bit;
+}
+
+void BatchedSimulator::setState(unsigned int lane, simulator_id_t id, logic_state_t state) {
+	if (lane >= laneCount || id >= idCount) {
+		logError("Lane {} or id {} out of range", "BatchedSimulator::setState", lane, id);
+		return;
+	}
+	writeState(statesA, lane, id, state);
+	writeState(statesB, lane, id, state);
+	junctionsDirty = true;
+}
+
+logic_state_t BatchedSimulator::getState(unsigned int lane, simulator_id_t id) {
+	if (lane >= laneCount || id >= idCount) {
+		return logic_state_t::UNDEFINED;
+	}
+	settleJunctions();
+	const unsigned int word = lane / lanesPerWord;
+	const unsigned int shift = lane % lanesPerWord;
+	const unsigned int value = (valuePlane(statesA, id)[word] >> shift) & 1u;
+	const unsigned int invalid = (invalidPlane(statesA, id)[word] >> shift) & 1u;
+	return static_cast<logic_state_t>(value | (invalid << 1));
+}
+
+std::vector<logic_state_t> BatchedSimulator::getStates(unsigned int lane, const std::vector<simulator_id_t>& ids) {
+	std::vector<logic_state_t> result;
+	result.reserve(ids.size());
+	for (simulator_id_t id : ids) {
+		result.push_back(getState(lane, id));
+	}
+	return result;
+}
+
+void BatchedSimulator::tick(unsigned int nTicks) {
+	for (unsigned int i = 0; i < nTicks; ++i) {
+		tickOnce();
+	}
+}
+
+// writes one word of a gate output to statesB, going through UNDEFINED first when realistic (see realisticState)
+void BatchedSimulator::commitGate(simulator_id_t id, unsigned int word, lane_word_t value, lane_word_t invalid) {
+	if (realistic) {
+		const lane_word_t currentValue = valuePlane(statesA, id)[word];
+		const lane_word_t currentInvalid = invalidPlane(statesA, id)[word];
+		const lane_word_t keep = (currentValue & currentInvalid) | ~((currentValue ^ value) | (currentInvalid ^ invalid));
+		value = (keep & value) | ~keep;
+		invalid = (keep & invalid) | ~keep;
+	}
+	valuePlane(statesB, id)[word] = value;
+	invalidPlane(statesB, id)[word] = invalid;
+}
+
+// junctions are resolved in order and in place, as in LogicSimulator::tickJunctions
+void BatchedSimulator::resolveJunctions(std::vector<lane_word_t>& states) {
+	for (size_t i = 0; i < junctions.size(); ++i) {
+		const simulator_id_t id = junctions.outputId(i);
+		for (unsigned int word = 0; word < laneWords; ++word) {
+			lane_word_t value;
+			lane_word_t invalid;
+			resolveDrivers(junctions.rangeBegin(i), junctions.rangeEnd(i), states.data(), stride, laneWords, word, value, invalid);
+			valuePlane(states, id)[word] = value;
+			invalidPlane(states, id)[word] = invalid;
+		}
+	}
+}
+
+void BatchedSimulator::settleJunctions() {
+	if (!junctionsDirty) return;
+	resolveJunctions(statesB);
+	for (size_t i = 0; i < junctions.size(); ++i) {
+		const simulator_id_t id = junctions.outputId(i);
+		std::copy_n(valuePlane(statesB, id), stride, valuePlane(statesA, id));
+	}
+	junctionsDirty = false;
+}
+
+void BatchedSimulator::tickOnce() {
+	settleJunctions();
+	const lane_word_t* states = statesA.data();
+	auto readValue = [&](simulator_id_t id, unsigned int word) { return states[id * stride + word]; };
+	auto readInvalid = [&](simulator_id_t id, unsigned int word) { return states[id * stride + laneWords + word]; };
+
+	for (size_t i = 0; i < andGates.size(); ++i) {
+		const simulator_id_t* begin = andGates.rangeBegin(i);
+		const simulator_id_t* end = andGates.rangeEnd(i);
+		const bool inputsInverted = andGates.hasFlag(i, CompiledGateList::INPUTS_INVERTED);
+		const lane_word_t outputInverted = broadcast(andGates.hasFlag(i, CompiledGateList::OUTPUT_INVERTED));
+		for (unsigned int word = 0; word < laneWords; ++word) {
+			if (begin == end) {
+				commitGate(andGates.outputId(i), word, 0, 0);
+				continue;
+			}
+			// the decisive state wins over any unknown/floating input
+			lane_word_t decisive = 0;
+			lane_word_t invalid = 0;
+			for (const simulator_id_t* it = begin; it != end; ++it) {
+				const lane_word_t v = readValue(*it, word);
+				const lane_word_t x = readInvalid(*it, word);
+				decisive |= ~x & (inputsInverted ? v : ~v);
+				invalid |= x;
+			}
+			const lane_word_t value = (decisive & outputInverted) | (~decisive & (invalid | ~outputInverted));
+			commitGate(andGates.outputId(i), word, value, ~decisive & invalid);
+		}
+	}
+	for (size_t i = 0; i < xorGates.size(); ++i) {
+		const simulator_id_t* begin = xorGates.rangeBegin(i);
+		const simulator_id_t* end = xorGates.rangeEnd(i);
+		const lane_word_t outputInverted = broadcast(xorGates.hasFlag(i, CompiledGateList::OUTPUT_INVERTED));
+		for (unsigned int word = 0; word < laneWords; ++word) {
+			if (begin == end) {
+				commitGate(xorGates.outputId(i), word, 0, 0);
+				continue;
+			}
+			lane_word_t parity = outputInverted;
+			lane_word_t invalid = 0;
+			for (const simulator_id_t* it = begin; it != end; ++it) {
+				parity ^= readValue(*it, word);
+				invalid |= readInvalid(*it, word);
+			}
+			commitGate(xorGates.outputId(i), word, parity | invalid, invalid);
+		}
+	}
+	for (size_t i = 0; i < tristateBuffers.size(); ++i) {
+		const bool enableInverted = tristateBuffers.hasFlag(i, CompiledGateList::ENABLE_INVERTED);
+		const bool hasInputs = tristateBuffers.rangeBegin(i, 0) != tristateBuffers.rangeEnd(i, 0);
+		for (unsigned int word = 0; word < laneWords; ++word) {
+			lane_word_t enableLow = 0;
+			lane_word_t enableHigh = 0;
+			lane_word_t enableUndefined = 0;
+			for (const simulator_id_t* it = tristateBuffers.rangeBegin(i, 1); it != tristateBuffers.rangeEnd(i, 1); ++it) {
+				const lane_word_t v = readValue(*it, word);
+				const lane_word_t x = readInvalid(*it, word);
+				enableLow |= ~v & ~x;
+				enableHigh |= v & ~x;
+				enableUndefined |= v & x;
+			}
+			const lane_word_t undefined = enableUndefined | ~(enableLow ^ enableHigh);
+			const lane_word_t driving = ~undefined & (enableInverted ? enableLow : enableHigh);
+			const lane_word_t floating = ~undefined & ~driving;
+			lane_word_t inputValue = allLanes;
+			lane_word_t inputInvalid = allLanes;
+			if (hasInputs) {
+				resolveDrivers(tristateBuffers.rangeBegin(i, 0), tristateBuffers.rangeEnd(i, 0), states, stride, laneWords, word, inputValue, inputInvalid);
+			}
+			commitGate(tristateBuffers.outputId(i), word, undefined | (driving & inputValue), undefined | floating | (driving & inputInvalid));
+		}
+	}
+	for (size_t i = 0; i < constantResetIds.size(); ++i) {
+		const unsigned int state = static_cast<unsigned int>(constantResetStates[i]);
+		std::fill_n(valuePlane(statesB, constantResetIds[i]), laneWords, broadcast(state & 1u));
+		std::fill_n(invalidPlane(statesB, constantResetIds[i]), laneWords, broadcast(state & 2u));
+	}
+	for (simulator_id_t id : copySelfOutputIds) {
+		std::copy_n(valuePlane(statesA, id), stride, valuePlane(statesB, id));
+	}
+	for (auto& gate : delayGates) {
+		const lane_word_t outputInverted = broadcast(gate.outputInverted);
+		lane_word_t* slot = delayLines.data() + gate.delayLineOffset + gate.delayHead * stride;
+		for (unsigned int word = 0; word < laneWords; ++word) {
+			// same as BufferGate::calculate, anything but a valid 0/1 becomes UNDEFINED
+			lane_word_t value = 0;
+			lane_word_t invalid = 0;
+			if (gate.inputId.has_value()) {
+				invalid = readInvalid(gate.inputId.value(), word);
+				value = invalid | (readValue(gate.inputId.value(), word) ^ outputInverted);
+			}
+			if (gate.extraDelayTicks != 0) {
+				std::swap(value, slot[word]);
+				std::swap(invalid, slot[laneWords + word]);
+			}
+			commitGate(gate.outputId, word, value, invalid);
+		}
+		if (gate.extraDelayTicks != 0 && ++gate.delayHead == gate.extraDelayTicks) {
+			gate.delayHead = 0;
+		}
+	}
+
+	resolveJunctions(statesB);
+	std::swap(statesA, statesB);
+}
@@ -0,0 +1,77 @@
+#ifndef batchedSimulator_h
+#define batchedSimulator_h
+
+#include "compiledGates.h"
+#include "evalTypedef.h"
+#include "logicState.h"
+
+class LogicSimulator;
+
+// Simulates one netlist for many independent lanes at once, for running the same circuit against many
+// stimulus vectors. The netlist is copied out of a LogicSimulator, so lanes use its simulator ids and
+// later edits to the circuit do not reach the batch. Every lane starts in the state the simulator was in.
+//
+// States are lane interleaved: each id owns laneWords words per bit plane, and lane l is bit l % 64 of
+// word l / 64. Plane 0 holds bit 0 of logic_state_t (the driven value) and plane 1 holds bit 1 (not a
+// valid 0/1), so every gate kernel handles 64 lanes with a few word operations per input.
+// Ticks follow EvaluationMode::FULL. A batch is not thread safe; run separate batches on separate threads.
+class BatchedSimulator {
+public:
+	typedef std::uint64_t lane_word_t;
+	static constexpr unsigned int lanesPerWord = 64;
+
+	// must be called with the simulator paused
+	BatchedSimulator(const LogicSimulator& simulator, unsigned int laneCount, bool realistic);
+
+	unsigned int getLaneCount() const { return laneCount; }
+
+	void tick(unsigned int nTicks = 1);
+
+	// like LogicSimulator::setState, junctions are resolved again before the next tick or read
+	void setState(unsigned int lane, simulator_id_t id, logic_state_t state);
+	void setState(unsigned int lane, simulator_id_t id, bool state) { setState(lane, id, fromBool(state)); }
+	logic_state_t getState(unsigned int lane, simulator_id_t id);
+	std::vector<logic_state_t> getStates(unsigned int lane, const std::vector<simulator_id_t>& ids);
+
+private:
+	struct DelayGate {
+		simulator_id_t outputId;
+		std::optional<simulator_id_t> inputId;
+		bool outputInverted;
+		unsigned int extraDelayTicks;
+		unsigned int delayHead;
+		size_t delayLineOffset; // into delayLines, extraDelayTicks entries of stride words each
+	};
+
+	unsigned int laneCount;
+	unsigned int laneWords;
+	size_t stride; // words per id, laneWords words per plane
+	size_t idCount;
+	bool realistic;
+	bool junctionsDirty = false;
+
+	CompiledGateList andGates;
+	CompiledGateList xorGates;
+	CompiledGateList junctions;
+	CompiledGateList tristateBuffers;
+	std::vector<simulator_id_t> constantResetIds;
+	std::vector<logic_state_t> constantResetStates;
+	std::vector<simulator_id_t> copySelfOutputIds;
+	std::vector<DelayGate> delayGates;
+	std::vector<lane_word_t> delayLines;
+
+	std::vector<lane_word_t> statesA;
+	std::vector<lane_word_t> statesB;
+
+	lane_word_t* valuePlane(std::vector<lane_word_t>& states, simulator_id_t id) { return states.data() + id * stride; }
+	lane_word_t* invalidPlane(std::vector<lane_word_t>& states, simulator_id_t id) { return states.data() + id * stride + laneWords; }
+
+	void fillState(simulator_id_t id, logic_state_t state);
+	void writeState(std::vector<lane_word_t>& states, unsigned int lane, simulator_id_t id, logic_state_t state);
+	void commitGate(simulator_id_t id, unsigned int word, lane_word_t value, lane_word_t invalid);
+	void resolveJunctions(std::vector<lane_word_t>& states);
+	void settleJunctions();
+	void tickOnce();
+};
+
+#endif /* batchedSimulator_h */
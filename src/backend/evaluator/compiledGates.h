@@ -0,0 +1,78 @@
+#ifndef compiledGates_h
+#define compiledGates_h
+
+#include "evalTypedef.h"
+
+// Flattened, read only copy of one gate type that the tick loop runs over. The per gate structs in
+// simulatorGates.h stay the edit time representation; LogicSimulator rebuilds this from them after
+// every edit so that all fan-in lists of a type live in one contiguous array (CSR layout).
+//
+// Gate i owns rangesPerGate input ranges. Range r of gate i is
+// inputIds[offsets[i * rangesPerGate + r], offsets[i * rangesPerGate + r + 1]).
+class CompiledGateList {
+public:
+	// per gate flag bits
+	static constexpr std::uint8_t INPUTS_INVERTED = 1 << 0;
+	static constexpr std::uint8_t OUTPUT_INVERTED = 1 << 1;
+	static constexpr std::uint8_t ENABLE_INVERTED = 1 << 2;
+
+	void reset(size_t rangesPerGate, size_t gateCount) {
+		this->rangesPerGate = rangesPerGate;
+		outputIds.clear();
+		flags.clear();
+		offsets.clear();
+		inputIds.clear();
+		outputIds.reserve(gateCount);
+		flags.reserve(gateCount);
+		offsets.reserve(gateCount * rangesPerGate + 1);
+		offsets.push_back(0);
+	}
+
+	void addGate(simulator_id_t outputId, std::uint8_t gateFlags = 0) {
+		outputIds.push_back(outputId);
+		flags.push_back(gateFlags);
+	}
+
+	// must be called rangesPerGate times after each addGate
+	void addRange(const std::vector<simulator_id_t>& ids) {
+		inputIds.insert(inputIds.end(), ids.begin(), ids.end());
+		offsets.push_back(static_cast<std::uint32_t>(inputIds.size()));
+	}
+
+	size_t size() const { return outputIds.size(); }
+	size_t getRangesPerGate() const { return rangesPerGate; }
+
+	simulator_id_t outputId(size_t gate) const { return outputIds[gate]; }
+	bool hasFlag(size_t gate, std::uint8_t flag) const { return flags[gate] & flag; }
+	std::uint8_t getFlags(size_t gate) const { return flags[gate]; }
+
+	const simulator_id_t* rangeBegin(size_t gate, size_t range = 0) const {
+		return inputIds.data() + offsets[gate * rangesPerGate + range];
+	}
+	const simulator_id_t* rangeEnd(size_t gate, size_t range = 0) const {
+		return inputIds.data() + offsets[gate * rangesPerGate + range + 1];
+	}
+
+private:
+	size_t rangesPerGate = 1;
+	std::vector<simulator_id_t> outputIds;
+	std::vector<std::uint8_t> flags;
+	std::vector<std::uint32_t> offsets { 0 };
+	std::vector<simulator_id_t> inputIds;
+};
+
+// Reference from a simulator id to the compiled gate that drives it or reads it
+struct CompiledGateRef {
+	enum class Kind : std::uint8_t {
+		NONE,
+		AND,
+		XOR,
+		TRISTATE_BUFFER,
+		JUNCTION
+	};
+
+	Kind kind = Kind::NONE;
+	std::uint32_t index = 0;
+};
+
+#endif /* compiledGates_h */
@@ -4,26 +4,118 @@
 #include "backend/container/difference.h"
 #include "backend/circuit/circuit.h"
 #include "backend/circuit/circuitManager.h"
+#include "evalConnection.h"
+#include "gateType.h"
 
+// A circuit compiled for placing it as an IC. Every instance places the same gates and makes the same
+// internal connections, so those are resolved once and instances only allocate their own ids.
+struct ICTemplate {
+	struct Gate {
+		Position position;
+		GateType gateType;
+		bool isPort; // the block sits on one of the circuit's IO positions
+	};
+	struct Connection {
+		unsigned int outputGate; // indices into gates
+		connection_port_id_t outputPort;
+		unsigned int inputGate;
+		connection_port_id_t inputPort;
+	};
+	std::vector<Gate> gates;
+	std::vector<Connection> connections;
+	// nested ICs and the connections that touch them, replayed per instance
+	std::vector<Difference::Modification> remainingModifications;
+};
+
+typedef std::shared_ptr<const ICTemplate> SharedICTemplate;
+
+// The creation differences and IC templates of circuits, kept between edits. An entry is only handed out while
+// the circuit's edit count still matches the count it was built at.
+class CompiledCircuitCache {
+public:
+	struct Entry {
+		unsigned long long editCount;
+		DifferenceSharedPtr difference;
+		SharedICTemplate icTemplate;
+	};
+
+	inline const Entry* get(circuit_id_t circuitId, unsigned long long editCount) const {
+		auto iter = entries.find(circuitId);
+		if (iter == entries.end() || iter->second.editCount != editCount) {
+			return nullptr;
+		}
+		return &(iter->second);
+	}
+	inline void setDifference(circuit_id_t circuitId, unsigned long long editCount, DifferenceSharedPtr difference) {
+		Entry& entry = entries[circuitId];
+		if (entry.editCount != editCount) {
+			entry.icTemplate = nullptr;
+		}
+		entry.editCount = editCount;
+		entry.difference = std::move(difference);
+	}
+	// the template has to be built from the difference stored for the same edit count
+	inline void setTemplate(circuit_id_t circuitId, unsigned long long editCount, SharedICTemplate icTemplate) {
+		auto iter = entries.find(circuitId);
+		if (iter != entries.end() && iter->second.editCount == editCount) {
+			iter->second.icTemplate = std::move(icTemplate);
+		}
+	}
+	// for changes the edit count does not see, like moving the circuit's IO
+	inline void invalidate(circuit_id_t circuitId) {
+		entries.erase(circuitId);
+	}
+
+private:
+	std::unordered_map<circuit_id_t, Entry> entries;
+};
+
+// Lookups into the CompiledCircuitCache for one edit
 class DiffCache {
 public:
-	DiffCache(CircuitManager& circuitManager) : circuitManager(circuitManager) {}
+	DiffCache(CircuitManager& circuitManager, CompiledCircuitCache& compiledCircuitCache) : circuitManager(circuitManager), compiledCircuitCache(compiledCircuitCache) {}
 	inline DifferenceSharedPtr getDifference(circuit_id_t circuitId) {
-		if (cache.contains(circuitId)) {
-			return cache.at(circuitId);
+		auto circuit = circuitManager.getCircuit(circuitId);
+		if (!circuit) {
+			return nullptr;
+		}
+		const CompiledCircuitCache::Entry* entry = compiledCircuitCache.get(circuitId, circuit->getEditCount());
+		if (entry) {
+			return entry->difference;
+		}
+		DifferenceSharedPtr difference = circuit->getBlockContainer()->getCreationDifferenceShared();
+		compiledCircuitCache.setDifference(circuitId, circuit->getEditCount(), difference);
+		return difference;
+	}
+	inline bool hasDifference(circuit_id_t circuitId) const {
+		auto circuit = circuitManager.getCircuit(circuitId);
+		return circuit && compiledCircuitCache.get(circuitId, circuit->getEditCount());
+	}
+	inline void setDifference(circuit_id_t circuitId, DifferenceSharedPtr difference) {
+		auto circuit = circuitManager.getCircuit(circuitId);
+		if (circuit) {
+			compiledCircuitCache.setDifference(circuitId, circuit->getEditCount(), std::move(difference));
 		}
+	}
+
+	inline SharedICTemplate getTemplate(circuit_id_t circuitId) const {
+		auto circuit = circuitManager.getCircuit(circuitId);
+		if (!circuit) {
+			return nullptr;
+		}
+		const CompiledCircuitCache::Entry* entry = compiledCircuitCache.get(circuitId, circuit->getEditCount());
+		return entry ? entry->icTemplate : nullptr;
+	}
+	inline void setTemplate(circuit_id_t circuitId, SharedICTemplate icTemplate) {
 		auto circuit = circuitManager.getCircuit(circuitId);
 		if (circuit) {
-			auto difference = std::make_shared<Difference>(circuit->getBlockContainer()->getCreationDifference());
-			cache[circuitId] = difference;
-			return difference;
+			compiledCircuitCache.setTemplate(circuitId, circuit->getEditCount(), std::move(icTemplate));
 		}
-		return nullptr;
 	}
 
 private:
-	std::unordered_map<circuit_id_t, DifferenceSharedPtr> cache;
 	CircuitManager& circuitManager;
+	CompiledCircuitCache& compiledCircuitCache;
 };
 
 #endif /* diffCache_h */
@@ -1,9 +1,9 @@
 #include "evalCircuit.h"
 
 std::optional<CircuitNode> EvalCircuit::getNode(Position pos) const noexcept {
-	const CircuitNode* node = circuitNodes.get(pos);
-	if (node) {
-		return *node;
+	std::optional<unsigned int> slot = layout->getSlot(pos);
+	if (slot && *slot < circuitNodes.size()) {
+		return circuitNodes[*slot];
 	}
 	return std::nullopt;
 }
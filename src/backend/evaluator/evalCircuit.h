@@ -6,38 +6,118 @@
 #include "circuitNode.h"
 #include "evalTypedef.h"
 
+// Maps positions to node slots. Every EvalCircuit of the same circuit gets the same differences, so the
+// instances share one layout and each only stores its own nodes. A slot is released once no instance holds a
+// node in it and is reused by the next new position, so moving blocks around does not grow the layout.
+class EvalCircuitLayout {
+public:
+	std::optional<unsigned int> getSlot(Position pos) const noexcept {
+		const unsigned int* slot = slots.get(pos);
+		if (slot) {
+			return *slot;
+		}
+		return std::nullopt;
+	}
+	// called by an instance that puts a node in the slot of pos
+	unsigned int holdSlot(Position pos) {
+		unsigned int slot = getOrAddSlot(pos);
+		++slotHolders[slot];
+		return slot;
+	}
+	// called by an instance that removes its node from slot
+	void releaseSlot(unsigned int slot) {
+		if (--slotHolders[slot] != 0) return;
+		slots.remove(slotPositions[slot]);
+		freeSlots.push_back(slot);
+	}
+	Position getSlotPosition(unsigned int slot) const noexcept {
+		return slotPositions[slot];
+	}
+	size_t getSlotCount() const noexcept {
+		return slotPositions.size();
+	}
+private:
+	Sparse2dArray<unsigned int> slots;
+	std::vector<Position> slotPositions;
+	std::vector<unsigned int> slotHolders; // the number of instances with a node in each slot
+	std::vector<unsigned int> freeSlots;
+
+	unsigned int getOrAddSlot(Position pos) {
+		const unsigned int* slot = slots.get(pos);
+		if (slot) {
+			return *slot;
+		}
+		unsigned int newSlot;
+		if (freeSlots.empty()) {
+			newSlot = slotPositions.size();
+			slotPositions.push_back(pos);
+			slotHolders.push_back(0);
+		} else {
+			newSlot = freeSlots.back();
+			freeSlots.pop_back();
+			slotPositions[newSlot] = pos;
+		}
+		slots.insert(pos, newSlot);
+		return newSlot;
+	}
+};
+
+typedef std::shared_ptr<EvalCircuitLayout> SharedEvalCircuitLayout;
+
 class EvalCircuit {
 public:
-	EvalCircuit(eval_circuit_id_t id, eval_circuit_id_t parentEvalId, circuit_id_t circuitId)
-		: id(id), parentEvalId(parentEvalId), circuitId(circuitId) {}
+	EvalCircuit(eval_circuit_id_t id, eval_circuit_id_t parentEvalId, circuit_id_t circuitId, SharedEvalCircuitLayout layout)
+		: id(id), parentEvalId(parentEvalId), circuitId(circuitId), layout(std::move(layout)) {}
 	EvalCircuit(const EvalCircuit&) = delete;
 	EvalCircuit& operator=(const EvalCircuit&) = delete;
 	EvalCircuit(EvalCircuit&&) = default;
-	EvalCircuit& operator=(EvalCircuit&&) = default;
+	EvalCircuit& operator=(EvalCircuit&&) = delete;
+	~EvalCircuit() {
+		// a moved from instance has no layout
+		if (!layout) return;
+		for (unsigned int slot = 0; slot < circuitNodes.size(); ++slot) {
+			if (circuitNodes[slot]) layout->releaseSlot(slot);
+		}
+	}
 	std::optional<CircuitNode> getNode(Position pos) const noexcept;
 	circuit_id_t getCircuitId() const noexcept {
 		return circuitId;
 	}
 	void setNode(Position pos, CircuitNode node) {
-		circuitNodes.insert(pos, node);
+		std::optional<unsigned int> heldSlot = layout->getSlot(pos);
+		if (heldSlot && *heldSlot < circuitNodes.size() && circuitNodes[*heldSlot]) {
+			circuitNodes[*heldSlot] = node;
+			return;
+		}
+		unsigned int slot = layout->holdSlot(pos);
+		if (slot >= circuitNodes.size()) {
+			circuitNodes.resize(slot + 1);
+		}
+		circuitNodes[slot] = node;
 	}
 	void removeNode(Position pos) {
-		circuitNodes.remove(pos);
+		std::optional<unsigned int> slot = layout->getSlot(pos);
+		if (slot && *slot < circuitNodes.size() && circuitNodes[*slot]) {
+			circuitNodes[*slot].reset();
+			layout->releaseSlot(*slot);
+		}
 	}
 	void moveNode(Position oldPos, Position newPos) {
 		std::optional<CircuitNode> node = getNode(oldPos);
 		if (node) {
-			circuitNodes.remove(oldPos);
-			circuitNodes.insert(newPos, node.value());
+			removeNode(oldPos);
+			setNode(newPos, node.value());
 		} else {
 			logError("Node at position {} not found", "EvalCircuit::moveNode", oldPos.toString());
 		}
 	}
 	template<typename F>
 	void forEachNode(F&& func) const {
-		circuitNodes.forEach([&func](Position pos, const CircuitNode& node) {
-			func(pos, node);
-		});
+		for (unsigned int slot = 0; slot < circuitNodes.size(); ++slot) {
+			if (circuitNodes[slot]) {
+				func(layout->getSlotPosition(slot), *circuitNodes[slot]);
+			}
+		}
 	}
 	bool isRoot() const noexcept {
 		return parentEvalId == id;
@@ -49,19 +129,19 @@ public:
 		return parentEvalId;
 	}
 	std::optional<Position> getPosition(CircuitNode node) const noexcept {
-		std::optional<Position> result = std::nullopt;
-		circuitNodes.forEach([&](Position pos, CircuitNode n) {
-			if (n == node) {
-				result = pos;
+		for (unsigned int slot = 0; slot < circuitNodes.size(); ++slot) {
+			if (circuitNodes[slot] == node) {
+				return layout->getSlotPosition(slot);
 			}
-		});
-		return result;
+		}
+		return std::nullopt;
 	}
 private:
 	eval_circuit_id_t id;
 	eval_circuit_id_t parentEvalId;
 	circuit_id_t circuitId;
-	Sparse2dArray<CircuitNode> circuitNodes;
+	SharedEvalCircuitLayout layout;
+	std::vector<std::optional<CircuitNode>> circuitNodes; // indexed by layout slot
 };
 
 #endif /* evalCircuit_h */
@@ -5,7 +5,13 @@ eval_circuit_id_t EvalCircuitContainer::addCircuit(eval_circuit_id_t parentEvalI
 	if (newCircuitId >= circuits.size()) {
 		circuits.resize(newCircuitId + 1, nullptr);
 	}
-	circuits[newCircuitId] = new EvalCircuit(newCircuitId, parentEvalId, circuitId);
+	// instances of a circuit share its layout, the layout goes away with the last instance
+	SharedEvalCircuitLayout layout = layouts[circuitId].lock();
+	if (!layout) {
+		layout = std::make_shared<EvalCircuitLayout>();
+		layouts[circuitId] = layout;
+	}
+	circuits[newCircuitId] = new EvalCircuit(newCircuitId, parentEvalId, circuitId, std::move(layout));
 	return newCircuitId;
 }
 
@@ -59,6 +59,7 @@ public:
 
 private:
 	std::vector<EvalCircuit*> circuits;
+	std::unordered_map<circuit_id_t, std::weak_ptr<EvalCircuitLayout>> layouts;
 	IdProvider<eval_circuit_id_t> evalCircuitIdProvider;
 };
 
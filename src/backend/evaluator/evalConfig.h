@@ -1,6 +1,12 @@
 #ifndef evalConfig_h
 #define evalConfig_h
 
+enum class EvaluationMode : int {
+	FULL = 0, // every gate is evaluated every tick
+	EVENT_DRIVEN = 1, // only gates whose inputs changed in the previous tick are evaluated
+	LEVELIZED = 2 // acyclic logic settles within one tick, only feedback loops keep unit delay. ignores realistic
+};
+
 class EvalConfig {
 public:
 	EvalConfig() = default;
@@ -41,6 +47,75 @@ public:
 		notifySubscribers();
 	}
 
+	inline EvaluationMode getEvaluationMode() const {
+		return evaluationMode.load();
+	}
+
+	inline void setEvaluationMode(EvaluationMode mode) {
+		evaluationMode.store(mode);
+		notifySubscribers();
+	}
+
+	// 0 picks a thread count from the hardware
+	inline unsigned int getThreadCount() const {
+		return threadCount.load();
+	}
+
+	inline void setThreadCount(unsigned int count) {
+		threadCount.store(count);
+		notifySubscribers();
+	}
+
+	inline bool isThreadPinningEnabled() const {
+		return threadPinning.load();
+	}
+
+	inline void setThreadPinning(bool enabled) {
+		threadPinning.store(enabled);
+		notifySubscribers();
+	}
+
+	// place ICs from a compiled template shared by every instance instead of replaying the IC's creation edit.
+	// only read while editing, so the simulator is not notified
+	inline bool isICInstancingEnabled() const {
+		return icInstancing.load();
+	}
+
+	inline void setICInstancing(bool enabled) {
+		icInstancing.store(enabled);
+	}
+
+	// fold gates whose inputs are all constant into constants when an edit ends. Off by default, as a folded gate
+	// settles at once instead of ticking (and going through UNDEFINED when realistic) after an edit. already folded
+	// gates stay folded when this is turned off, so it is best set before the circuit is built
+	inline bool isConstantFoldingEnabled() const {
+		return constantFolding.load();
+	}
+
+	inline void setConstantFolding(bool enabled) {
+		constantFolding.store(enabled);
+	}
+
+	// merge gates that have the same type and are driven by the same outputs into one simulated gate. Off by
+	// default, merged gates report the state and simulator id of the gate they were merged into
+	inline bool isGateMergingEnabled() const {
+		return gateMerging.load();
+	}
+
+	inline void setGateMerging(bool enabled) {
+		gateMerging.store(enabled);
+	}
+
+	// number of steps (ticks and external state changes) LogicSimulator keeps to step back through, 0 turns the recording off
+	inline unsigned int getHistoryDepth() const {
+		return historyDepth.load();
+	}
+
+	inline void setHistoryDepth(unsigned int depth) {
+		historyDepth.store(depth);
+		notifySubscribers();
+	}
+
 	inline void addSprint(int nTicks) {
 		sprintCounter.fetch_add(nTicks);
 		notifySubscribers();
@@ -48,6 +123,7 @@ public:
 
 	inline void resetSprintCount() {
 		sprintCounter.store(0);
+		sprintCounter.notify_all();
 		notifySubscribers();
 	}
 
@@ -55,16 +131,25 @@ public:
 		return sprintCounter.load();
 	}
 
+	// LogicSimulator counts a sprint tick down once the tick is finished, so a count of 0 means every state is written
 	inline bool consumeSprintTick() {
 		int expected = sprintCounter.load(std::memory_order_relaxed);
 		while (expected > 0) {
 			if (sprintCounter.compare_exchange_weak(expected, expected - 1, std::memory_order_acq_rel)) {
+				if (expected == 1) sprintCounter.notify_all();
 				return true;
 			}
 		}
 		return false;
 	}
 
+	inline void waitForSprintComplete() const {
+		int count;
+		while ((count = sprintCounter.load(std::memory_order_acquire)) > 0) {
+			sprintCounter.wait(count, std::memory_order_acquire);
+		}
+	}
+
 	inline void subscribe(std::function<void()> callback) {
 		std::lock_guard<std::mutex> lock(subscribersMutex);
 		subscribers.push_back(callback);
@@ -80,6 +165,13 @@ private:
 	std::atomic<bool> tickrateLimiter = true;
 	std::atomic<bool> running = false;
 	std::atomic<bool> realistic = false;
+	std::atomic<EvaluationMode> evaluationMode = EvaluationMode::FULL;
+	std::atomic<unsigned int> threadCount = 0;
+	std::atomic<bool> threadPinning = false;
+	std::atomic<bool> icInstancing = true;
+	std::atomic<bool> constantFolding = false;
+	std::atomic<bool> gateMerging = false;
+	std::atomic<unsigned int> historyDepth = 0;
 	std::atomic<int> sprintCounter = 0;
 
 	std::vector<std::function<void()>> subscribers;
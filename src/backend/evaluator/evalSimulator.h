@@ -15,9 +15,39 @@ public:
 	inline void endEdit(SimPauseGuard& pauseGuard) {
 		gateSubstituter.endEdit(pauseGuard);
 	}
+	inline void renumberForLocality(SimPauseGuard& pauseGuard) {
+		gateSubstituter.renumberForLocality(pauseGuard);
+	}
+	inline void compactSimulatorIds(SimPauseGuard& pauseGuard) {
+		gateSubstituter.compactSimulatorIds(pauseGuard);
+	}
+	inline BatchedSimulator makeBatchedSimulator(SimPauseGuard& pauseGuard, unsigned int laneCount) {
+		return gateSubstituter.makeBatchedSimulator(pauseGuard, laneCount);
+	}
+	inline void clearState(SimPauseGuard& pauseGuard) {
+		gateSubstituter.clearState(pauseGuard);
+	}
+	inline SimulatorSnapshot takeSnapshot(SimPauseGuard& pauseGuard) {
+		return gateSubstituter.takeSnapshot(pauseGuard);
+	}
+	inline bool restoreSnapshot(SimPauseGuard& pauseGuard, const SimulatorSnapshot& snapshot) {
+		return gateSubstituter.restoreSnapshot(pauseGuard, snapshot);
+	}
+	inline unsigned int stepBack(SimPauseGuard& pauseGuard, unsigned int nTicks) {
+		return gateSubstituter.stepBack(pauseGuard, nTicks);
+	}
+	inline unsigned int stepForward(SimPauseGuard& pauseGuard, unsigned int nTicks) {
+		return gateSubstituter.stepForward(pauseGuard, nTicks);
+	}
+	inline void setWaveformRecorder(SimPauseGuard& pauseGuard, std::shared_ptr<WaveformRecorder> recorder) {
+		gateSubstituter.setWaveformRecorder(pauseGuard, std::move(recorder));
+	}
 	inline void addGate(SimPauseGuard& pauseGuard, const GateType gateType, const middle_id_t gateId) {
 		gateSubstituter.addGate(pauseGuard, gateType, gateId);
 	}
+	inline void addDelayGate(SimPauseGuard& pauseGuard, unsigned int delayTicks, const middle_id_t gateId) {
+		gateSubstituter.addDelayGate(pauseGuard, delayTicks, gateId);
+	}
 	inline void removeGate(SimPauseGuard& pauseGuard, const middle_id_t gateId) {
 		gateSubstituter.removeGate(pauseGuard, gateId);
 	}
@@ -33,6 +63,15 @@ public:
 	inline std::vector<logic_state_t> getStatesFromSimulatorIds(const std::vector<simulator_id_t>& simulatorIds) const {
 		return gateSubstituter.getStatesFromSimulatorIds(simulatorIds);
 	}
+	inline state_change_feed_id_t subscribeStateChanges() {
+		return gateSubstituter.subscribeStateChanges();
+	}
+	inline void unsubscribeStateChanges(state_change_feed_id_t feed) {
+		gateSubstituter.unsubscribeStateChanges(feed);
+	}
+	inline std::vector<simulator_id_t> takeChangedSimulatorIds(state_change_feed_id_t feed) {
+		return gateSubstituter.takeChangedSimulatorIds(feed);
+	}
 	inline std::vector<SimulatorStateAndPinSimId> getSimulatorIds(const std::vector<EvalConnectionPoint>&points) const {
 		return gateSubstituter.getSimulatorIds(points);
 	}
@@ -29,37 +29,288 @@ evalSimulator(evalConfig, middleIdProvider, dirtySimulatorIds) {
 	logInfo("Creating Evaluator with ID {} for Circuit ID {}", "Evaluator", evaluatorId, circuitId);
 	evalCircuitContainer.addCircuit(0, circuitId);
 	const auto blockContainer = circuit->getBlockContainer();
-	const Difference difference = blockContainer->getCreationDifference();
+	DifferenceSharedPtr difference = blockContainer->getCreationDifferenceShared();
 	receiver.linkFunction("circuitBlockDataConnectionPositionRemove", std::bind(&Evaluator::removeCircuitIO, this, std::placeholders::_1));
 	receiver.linkFunction("circuitBlockDataConnectionPositionSet", std::bind(&Evaluator::setCircuitIO, this, std::placeholders::_1));
 
-	makeEdit(std::make_shared<Difference>(difference), circuitId);
+	DiffCache diffCache(circuitManager, compiledCircuitCache);
+	preloadICDefinitions(diffCache, difference);
+	makeEdit(difference, circuitId, diffCache);
 }
 
 void Evaluator::makeEdit(DifferenceSharedPtr difference, circuit_id_t circuitId) {
+	DiffCache diffCache(circuitManager, compiledCircuitCache);
+	makeEdit(difference, circuitId, diffCache);
+}
+
+void Evaluator::makeEdit(DifferenceSharedPtr difference, circuit_id_t circuitId, DiffCache& diffCache) {
 #ifdef TRACY_PROFILER
 	ZoneScoped;
 #endif
-	changedICs = false;
 	// logInfo("_________________________________________________________________________________________");
 	// logInfo("Applying edit to Evaluator with ID {} for Circuit ID {}", "Evaluator::makeEdit", evaluatorId, circuitId);
-	{
-		SimPauseGuard pauseGuard = evalSimulator.beginEdit();
-		std::unique_lock lk(simMutex);
-		DiffCache diffCache(circuitManager);
-		for (eval_circuit_id_t evalCircuitId = 0; evalCircuitId < evalCircuitContainer.size(); evalCircuitId++) {
-			if (evalCircuitContainer.getCircuitId(evalCircuitId) == circuitId) {
-				makeEditInPlace(pauseGuard, evalCircuitId, difference, diffCache);
+	beginEditBatch();
+	for (eval_circuit_id_t evalCircuitId = 0; evalCircuitId < evalCircuitContainer.size(); evalCircuitId++) {
+		if (evalCircuitContainer.getCircuitId(evalCircuitId) == circuitId) {
+			makeEditInPlace(*editBatchPauseGuard, evalCircuitId, difference, diffCache);
+		}
+	}
+	commitEditBatch();
+}
+
+// Builds the creation differences and templates of every IC below the loaded circuit on a temporary thread pool
+// before anything is placed. Placing still happens on this thread, but it then only has to instance the templates.
+void Evaluator::preloadICDefinitions(DiffCache& diffCache, DifferenceSharedPtr difference) {
+#ifdef TRACY_PROFILER
+	ZoneScoped;
+#endif
+	struct PreloadJob {
+		const Evaluator* evaluator;
+		circuit_id_t circuitId;
+		DifferenceSharedPtr difference;
+		SharedICTemplate icTemplate;
+		bool compileTemplate;
+	};
+	auto runPreloadJob = [](void* arg) {
+		PreloadJob* job = static_cast<PreloadJob*>(arg);
+		const SharedCircuit circuit = job->evaluator->circuitManager.getCircuit(job->circuitId);
+		if (!circuit) {
+			return;
+		}
+		job->difference = circuit->getBlockContainer()->getCreationDifferenceShared();
+		if (job->compileTemplate) {
+			job->icTemplate = job->evaluator->compileICTemplate(job->circuitId, job->difference);
+		}
+	};
+	const bool compileTemplates = evalConfig.isICInstancingEnabled();
+
+	// one round per IC nesting level, the ICs of the next level are only known once this level's differences exist
+	std::unordered_set<circuit_id_t> seenCircuits;
+	std::vector<DifferenceSharedPtr> levelDifferences = { difference };
+	std::unique_ptr<ThreadPool> threadPool;
+	while (!levelDifferences.empty()) {
+		std::vector<PreloadJob> preloadJobs;
+		std::vector<DifferenceSharedPtr> nextLevelDifferences;
+		for (const DifferenceSharedPtr& levelDifference : levelDifferences) {
+			for (const Difference::Modification& modification : levelDifference->getModifications()) {
+				if (modification.first != Difference::ModificationType::PLACE_BLOCK) {
+					continue;
+				}
+				const BlockType blockType = std::get<2>(std::get<Difference::block_modification_t>(modification.second));
+				if (getGateType(blockType) != GateType::NONE) {
+					continue;
+				}
+				const circuit_id_t icCircuitId = circuitBlockDataManager.getCircuitId(blockType);
+				if (icCircuitId == 0 || !seenCircuits.insert(icCircuitId).second) {
+					continue;
+				}
+				// still compiled from an earlier edit
+				if (diffCache.hasDifference(icCircuitId) && (!compileTemplates || diffCache.getTemplate(icCircuitId))) {
+					nextLevelDifferences.push_back(diffCache.getDifference(icCircuitId));
+					continue;
+				}
+				preloadJobs.push_back({ this, icCircuitId, nullptr, nullptr, compileTemplates });
 			}
 		}
-		evalSimulator.endEdit(pauseGuard);
+		if (preloadJobs.size() == 1) {
+			runPreloadJob(&preloadJobs.front());
+		} else if (!preloadJobs.empty()) {
+			if (!threadPool) {
+				unsigned int threadCount = evalConfig.getThreadCount();
+				threadPool = threadCount == 0 ? std::make_unique<ThreadPool>() : std::make_unique<ThreadPool>(threadCount);
+			}
+			std::vector<ThreadPool::Job> jobs;
+			jobs.reserve(preloadJobs.size());
+			for (PreloadJob& preloadJob : preloadJobs) {
+				jobs.push_back({ runPreloadJob, &preloadJob });
+			}
+			threadPool->resetAndLoad(jobs);
+			threadPool->waitForCompletion();
+		}
+		for (const PreloadJob& preloadJob : preloadJobs) {
+			if (!preloadJob.difference) {
+				continue;
+			}
+			diffCache.setDifference(preloadJob.circuitId, preloadJob.difference);
+			if (preloadJob.icTemplate) {
+				diffCache.setTemplate(preloadJob.circuitId, preloadJob.icTemplate);
+			}
+			nextLevelDifferences.push_back(preloadJob.difference);
+		}
+		levelDifferences = std::move(nextLevelDifferences);
 	}
+}
+
+void Evaluator::beginEditBatch() {
+	if (editBatchDepth++ != 0) {
+		return;
+	}
+	changedICs = false;
+	// keeps the simulator paused and the readers out between the edits of the batch, so nobody sees an edit
+	// whose junction merges and folds are still pending
+	editBatchPauseGuard.reset(new SimPauseGuard(evalSimulator.beginEdit()));
+	editBatchLock = std::unique_lock(simMutex);
+}
+
+void Evaluator::commitEditBatch() {
+	if (editBatchDepth == 0) {
+		logError("commitEditBatch called without a matching beginEditBatch", "Evaluator::commitEditBatch");
+		return;
+	}
+	if (--editBatchDepth != 0) {
+		return;
+	}
+	evalSimulator.endEdit(*editBatchPauseGuard);
+	updateWaveformSimulatorIds(*editBatchPauseGuard);
+	editBatchLock.unlock();
+	editBatchPauseGuard.reset();
 	if (changedICs) {
 		dataUpdateEventManager->sendEvent("addressTreeMakeBranch");
 	}
 	processDirtyNodes();
 }
 
+void Evaluator::optimizeSimulatorLayout() {
+	{
+		SimPauseGuard pauseGuard = evalSimulator.beginEdit();
+		std::unique_lock lk(simMutex);
+		evalSimulator.renumberForLocality(pauseGuard);
+		evalSimulator.endEdit(pauseGuard);
+	}
+	processDirtyNodes();
+}
+
+void Evaluator::compactSimulatorIds() {
+	{
+		SimPauseGuard pauseGuard = evalSimulator.beginEdit();
+		std::unique_lock lk(simMutex);
+		evalSimulator.compactSimulatorIds(pauseGuard);
+		evalSimulator.endEdit(pauseGuard);
+	}
+	processDirtyNodes();
+}
+
+BatchedSimulator Evaluator::makeBatchedSimulator(unsigned int laneCount) {
+	SimPauseGuard pauseGuard = evalSimulator.beginEdit();
+	std::shared_lock lk(simMutex);
+	return evalSimulator.makeBatchedSimulator(pauseGuard, laneCount);
+}
+
+void Evaluator::reset() {
+	SimPauseGuard pauseGuard = evalSimulator.beginEdit();
+	std::shared_lock lk(simMutex);
+	evalSimulator.clearState(pauseGuard);
+}
+
+SimulatorSnapshot Evaluator::takeSnapshot() {
+	SimPauseGuard pauseGuard = evalSimulator.beginEdit();
+	std::shared_lock lk(simMutex);
+	return evalSimulator.takeSnapshot(pauseGuard);
+}
+
+bool Evaluator::restoreSnapshot(const SimulatorSnapshot& snapshot) {
+	SimPauseGuard pauseGuard = evalSimulator.beginEdit();
+	std::shared_lock lk(simMutex);
+	return evalSimulator.restoreSnapshot(pauseGuard, snapshot);
+}
+
+bool Evaluator::startWaveformCapture(const std::filesystem::path& path, const std::vector<Address>& addresses, WaveformFormat format) {
+	SimPauseGuard pauseGuard = evalSimulator.beginEdit();
+	std::shared_lock lk(simMutex);
+	std::vector<std::string> names;
+	std::vector<EvalPosition> positions;
+	for (const Address& address : addresses) {
+		// walk down the ICs of the address, it ends either on an IC or on a block inside the last one
+		eval_circuit_id_t evalCircuitId = 0;
+		int depth = 0;
+		for (; depth < address.size(); ++depth) {
+			std::optional<CircuitNode> node = evalCircuitContainer.getNode(address.getPosition(depth), evalCircuitId);
+			if (!node.has_value() || !node->isIC()) break;
+			evalCircuitId = node->getId();
+		}
+		if (depth == address.size()) {
+			collectWaveformSignals(evalCircuitId, address.toString(), names, positions);
+		} else if (depth == address.size() - 1) {
+			names.push_back(address.toString());
+			positions.push_back(EvalPosition(address.getPosition(depth), evalCircuitId));
+		} else {
+			logError("CircuitNode not found for address {}", "Evaluator::startWaveformCapture", address.toString());
+			return false;
+		}
+	}
+
+	std::vector<simulator_id_t> simulatorIds = getWaveformSimulatorIds(positions);
+	std::vector<WaveformSignal> signals;
+	std::vector<EvalPosition> signalPositions;
+	for (size_t i = 0; i < names.size(); ++i) {
+		// blocks without an output have nothing to record
+		if (simulatorIds[i] == 0) continue;
+		signals.push_back({ std::move(names[i]), simulatorIds[i] });
+		signalPositions.push_back(positions[i]);
+	}
+	auto recorder = std::make_shared<WaveformRecorder>(std::move(signals), format);
+	if (!recorder->start(path)) return false;
+	waveformRecorder = recorder;
+	waveformPositions = std::move(signalPositions);
+	evalSimulator.setWaveformRecorder(pauseGuard, std::move(recorder));
+	return true;
+}
+
+std::vector<simulator_id_t> Evaluator::getWaveformSimulatorIds(const std::vector<EvalPosition>& positions) const {
+	std::vector<std::optional<EvalConnectionPoint>> points;
+	points.reserve(positions.size());
+	for (const EvalPosition& position : positions) {
+		points.push_back(getConnectionPoint(position.evalCircuitId, position.position, Direction::OUT));
+	}
+	return evalSimulator.getBlockSimulatorIds(points);
+}
+
+void Evaluator::updateWaveformSimulatorIds(SimPauseGuard&) {
+	if (!waveformRecorder) return;
+	// removing, merging or folding gates can move a watched block to another id or reuse its id for another gate
+	waveformRecorder->setIds(getWaveformSimulatorIds(waveformPositions));
+}
+
+void Evaluator::collectWaveformSignals(eval_circuit_id_t evalCircuitId, const std::string& prefix, std::vector<std::string>& names, std::vector<EvalPosition>& positions) const {
+	const EvalCircuit* evalCircuit = evalCircuitContainer.getCircuit(evalCircuitId);
+	if (!evalCircuit) {
+		logError("EvalCircuit with id {} not found", "Evaluator::collectWaveformSignals", evalCircuitId);
+		return;
+	}
+	evalCircuit->forEachNode([&](Position position, const CircuitNode& node) {
+		std::string name = prefix.empty() ? position.toString() : prefix + "." + position.toString();
+		if (node.isIC()) {
+			collectWaveformSignals(node.getId(), name, names, positions);
+		} else {
+			names.push_back(std::move(name));
+			positions.push_back(EvalPosition(position, evalCircuitId));
+		}
+	});
+}
+
+void Evaluator::stopWaveformCapture() {
+	SimPauseGuard pauseGuard = evalSimulator.beginEdit();
+	std::shared_lock lk(simMutex);
+	// the recorder stops when the simulator lets go of it, after writing what it has
+	waveformRecorder.reset();
+	waveformPositions.clear();
+	evalSimulator.setWaveformRecorder(pauseGuard, nullptr);
+}
+
+unsigned int Evaluator::stepBack(unsigned int nTicks) {
+	setPause(true);
+	SimPauseGuard pauseGuard = evalSimulator.beginEdit();
+	std::shared_lock lk(simMutex);
+	return evalSimulator.stepBack(pauseGuard, nTicks);
+}
+
+unsigned int Evaluator::stepForward(unsigned int nTicks) {
+	setPause(true);
+	SimPauseGuard pauseGuard = evalSimulator.beginEdit();
+	std::shared_lock lk(simMutex);
+	return evalSimulator.stepForward(pauseGuard, nTicks);
+}
+
 void Evaluator::makeEditInPlace(SimPauseGuard& pauseGuard, eval_circuit_id_t evalCircuitId, DifferenceSharedPtr difference, DiffCache& diffCache) {
 #ifdef TRACY_PROFILER
 	ZoneScoped;
@@ -86,36 +337,39 @@ void Evaluator::makeEditInPlace(SimPauseGuard& pauseGuard, eval_circuit_id_t eva
 		return;
 	}
 
-	const std::vector<Difference::Modification>& modifications = difference->getModifications();
-	for (const Difference::Modification& modification : modifications) {
-		const auto& [modificationType, modificationData] = modification;
-		switch (modificationType) {
-		case Difference::ModificationType::REMOVED_BLOCK: {
-			const auto& [position, orientation, blockType] = std::get<Difference::block_modification_t>(modificationData);
-			edit_removeBlock(pauseGuard, evalCircuitId, diffCache, position, orientation, blockType);
-			break;
-		}
-		case Difference::ModificationType::PLACE_BLOCK: {
-			const auto& [position, orientation, blockType] = std::get<Difference::block_modification_t>(modificationData);
-			edit_placeBlock(pauseGuard, evalCircuitId, diffCache, position, orientation, blockType);
-			break;
-		}
-		case Difference::ModificationType::MOVE_BLOCK: {
-			const auto& [curPosition, curOrientation, newPosition, newOrientation] = std::get<Difference::move_modification_t>(modificationData);
-			edit_moveBlock(pauseGuard, evalCircuitId, diffCache, curPosition, curOrientation, newPosition, newOrientation);
-			break;
-		}
-		case Difference::ModificationType::REMOVED_CONNECTION: {
-			const auto& [outputBlockPosition, outputPosition, inputBlockPosition, inputPosition] = std::get<Difference::connection_modification_t>(modificationData);
-			edit_removeConnection(pauseGuard, evalCircuitId, diffCache, blockContainer, outputBlockPosition, outputPosition, inputBlockPosition, inputPosition);
-			break;
-		}
-		case Difference::ModificationType::CREATED_CONNECTION: {
-			const auto& [outputBlockPosition, outputPosition, inputBlockPosition, inputPosition] = std::get<Difference::connection_modification_t>(modificationData);
-			edit_createConnection(pauseGuard, evalCircuitId, diffCache, blockContainer, outputBlockPosition, outputPosition, inputBlockPosition, inputPosition);
-			break;
-		}
-		}
+	for (const Difference::Modification& modification : difference->getModifications()) {
+		applyModification(pauseGuard, evalCircuitId, diffCache, blockContainer, modification);
+	}
+}
+
+void Evaluator::applyModification(SimPauseGuard& pauseGuard, eval_circuit_id_t evalCircuitId, DiffCache& diffCache, const BlockContainer* blockContainer, const Difference::Modification& modification) {
+	const auto& [modificationType, modificationData] = modification;
+	switch (modificationType) {
+	case Difference::ModificationType::REMOVED_BLOCK: {
+		const auto& [position, orientation, blockType] = std::get<Difference::block_modification_t>(modificationData);
+		edit_removeBlock(pauseGuard, evalCircuitId, diffCache, position, orientation, blockType);
+		break;
+	}
+	case Difference::ModificationType::PLACE_BLOCK: {
+		const auto& [position, orientation, blockType] = std::get<Difference::block_modification_t>(modificationData);
+		edit_placeBlock(pauseGuard, evalCircuitId, diffCache, position, orientation, blockType);
+		break;
+	}
+	case Difference::ModificationType::MOVE_BLOCK: {
+		const auto& [curPosition, curOrientation, newPosition, newOrientation] = std::get<Difference::move_modification_t>(modificationData);
+		edit_moveBlock(pauseGuard, evalCircuitId, diffCache, curPosition, curOrientation, newPosition, newOrientation);
+		break;
+	}
+	case Difference::ModificationType::REMOVED_CONNECTION: {
+		const auto& [outputBlockPosition, outputPosition, inputBlockPosition, inputPosition] = std::get<Difference::connection_modification_t>(modificationData);
+		edit_removeConnection(pauseGuard, evalCircuitId, diffCache, blockContainer, outputBlockPosition, outputPosition, inputBlockPosition, inputPosition);
+		break;
+	}
+	case Difference::ModificationType::CREATED_CONNECTION: {
+		const auto& [outputBlockPosition, outputPosition, inputBlockPosition, inputPosition] = std::get<Difference::connection_modification_t>(modificationData);
+		edit_createConnection(pauseGuard, evalCircuitId, diffCache, blockContainer, outputBlockPosition, outputPosition, inputBlockPosition, inputPosition);
+		break;
+	}
 	}
 }
 
@@ -163,7 +417,7 @@ void Evaluator::edit_deleteICContents(SimPauseGuard& pauseGuard, eval_circuit_id
 	});
 }
 
-void Evaluator::edit_placeBlock(SimPauseGuard& pauseGuard, eval_circuit_id_t evalCircuitId, DiffCache& diffCache, Position position, Orientation orientation, BlockType type) {
+GateType Evaluator::getGateType(BlockType type) {
 	GateType gateType = GateType::NONE;
 	switch (type) {
 	case BlockType::AND: gateType = GateType::AND; break;
@@ -181,6 +435,11 @@ void Evaluator::edit_placeBlock(SimPauseGuard& pauseGuard, eval_circuit_id_t eva
 	case BlockType::LIGHT: gateType = GateType::JUNCTION; break;
 	default: break; // it was giving a warning
 	}
+	return gateType;
+}
+
+void Evaluator::edit_placeBlock(SimPauseGuard& pauseGuard, eval_circuit_id_t evalCircuitId, DiffCache& diffCache, Position position, Orientation orientation, BlockType type) {
+	GateType gateType = getGateType(type);
 	if (gateType == GateType::NONE) {
 		const circuit_id_t ICId = circuitBlockDataManager.getCircuitId(type);
 		if (ICId != 0) {
@@ -213,10 +472,159 @@ void Evaluator::edit_placeIC(SimPauseGuard& pauseGuard, eval_circuit_id_t evalCi
 	eval_circuit_id_t newEvalCircuitId = evalCircuitContainer.addCircuit(evalCircuitId, circuitId);
 	evalCircuit->setNode(position, CircuitNode::fromIC(newEvalCircuitId));
 	dirtyBlockAt(position, evalCircuitId);
+	if (evalConfig.isICInstancingEnabled()) {
+		SharedICTemplate icTemplate = getICTemplate(diffCache, circuitId);
+		if (icTemplate) {
+			instantiateICTemplate(pauseGuard, newEvalCircuitId, diffCache, *icTemplate);
+			return;
+		}
+	}
 	DifferenceSharedPtr diff = diffCache.getDifference(circuitId);
 	makeEditInPlace(pauseGuard, newEvalCircuitId, diff, diffCache);
 }
 
+SharedICTemplate Evaluator::getICTemplate(DiffCache& diffCache, circuit_id_t circuitId) {
+	SharedICTemplate cachedTemplate = diffCache.getTemplate(circuitId);
+	if (cachedTemplate) {
+		return cachedTemplate;
+	}
+	SharedICTemplate icTemplate = compileICTemplate(circuitId, diffCache.getDifference(circuitId));
+	if (icTemplate) {
+		diffCache.setTemplate(circuitId, icTemplate);
+	}
+	return icTemplate;
+}
+
+// only reads the circuits, so templates of different circuits can be compiled at the same time
+SharedICTemplate Evaluator::compileICTemplate(circuit_id_t circuitId, DifferenceSharedPtr difference) const {
+	const SharedCircuit circuit = circuitManager.getCircuit(circuitId);
+	if (!circuit || !difference) {
+		return nullptr;
+	}
+	const BlockContainer* blockContainer = circuit->getBlockContainer();
+	const CircuitBlockData* circuitBlockData = circuitBlockDataManager.getCircuitBlockData(circuitId);
+
+	std::shared_ptr<ICTemplate> icTemplate = std::make_shared<ICTemplate>();
+	std::unordered_map<Position, unsigned int> gateIndices;
+	for (const Difference::Modification& modification : difference->getModifications()) {
+		const auto& [modificationType, modificationData] = modification;
+		if (modificationType == Difference::ModificationType::PLACE_BLOCK) {
+			const auto& [position, orientation, blockType] = std::get<Difference::block_modification_t>(modificationData);
+			GateType gateType = getGateType(blockType);
+			if (gateType != GateType::NONE) {
+				gateIndices[position] = icTemplate->gates.size();
+				icTemplate->gates.push_back({ position, gateType, isICPort(circuitBlockData, blockContainer, position) });
+				continue;
+			}
+		} else if (modificationType == Difference::ModificationType::CREATED_CONNECTION) {
+			const auto& [outputBlockPosition, outputPosition, inputBlockPosition, inputPosition] = std::get<Difference::connection_modification_t>(modificationData);
+			auto outputGate = gateIndices.find(outputBlockPosition);
+			auto inputGate = gateIndices.find(inputBlockPosition);
+			if (outputGate != gateIndices.end() && inputGate != gateIndices.end()) {
+				std::optional<connection_port_id_t> outputPort = getGatePortId(blockContainer, outputPosition, Direction::OUT);
+				std::optional<connection_port_id_t> inputPort = getGatePortId(blockContainer, inputPosition, Direction::IN);
+				if (outputPort && inputPort) {
+					icTemplate->connections.push_back({ outputGate->second, outputPort.value(), inputGate->second, inputPort.value() });
+					continue;
+				}
+			}
+		}
+		icTemplate->remainingModifications.push_back(modification);
+	}
+	return icTemplate;
+}
+
+void Evaluator::instantiateICTemplate(SimPauseGuard& pauseGuard, eval_circuit_id_t evalCircuitId, DiffCache& diffCache, const ICTemplate& icTemplate) {
+	EvalCircuit* evalCircuit = evalCircuitContainer.getCircuit(evalCircuitId);
+	if (!evalCircuit) {
+		logError("EvalCircuit with id {} not found", "Evaluator::instantiateICTemplate", evalCircuitId);
+		return;
+	}
+	SharedCircuit circuit = circuitManager.getCircuit(evalCircuit->getCircuitId());
+	if (!circuit) {
+		logError("Circuit with id {} not found", "Evaluator::instantiateICTemplate", evalCircuit->getCircuitId());
+		return;
+	}
+	std::vector<middle_id_t> gateIds;
+	gateIds.reserve(icTemplate.gates.size());
+	for (const ICTemplate::Gate& gate : icTemplate.gates) {
+		middle_id_t gateId = middleIdProvider.getNewId();
+		evalSimulator.addGate(pauseGuard, gate.gateType, gateId);
+		evalCircuit->setNode(gate.position, CircuitNode::fromMiddle(gateId));
+		dirtyBlockAt(gate.position, evalCircuitId);
+		if (gate.isPort) {
+			checkToCreateExternalConnections(pauseGuard, evalCircuitId, gate.position);
+		}
+		gateIds.push_back(gateId);
+	}
+	for (const ICTemplate::Connection& connection : icTemplate.connections) {
+		evalSimulator.makeConnection(pauseGuard, EvalConnection(
+			EvalConnectionPoint(gateIds[connection.outputGate], connection.outputPort),
+			EvalConnectionPoint(gateIds[connection.inputGate], connection.inputPort)
+		));
+	}
+	for (const Difference::Modification& modification : icTemplate.remainingModifications) {
+		applyModification(pauseGuard, evalCircuitId, diffCache, circuit->getBlockContainer(), modification);
+	}
+}
+
+// the port a gate block connects through, same as getConnectionPoint for a non IC block
+std::optional<connection_port_id_t> Evaluator::getGatePortId(const BlockContainer* blockContainer, Position portPosition, Direction direction) const {
+	const Block* block = blockContainer->getBlock(portPosition);
+	if (!block) {
+		return std::nullopt;
+	}
+	switch (block->type()) {
+	case BlockType::SWITCH:
+	case BlockType::BUTTON:
+	case BlockType::TICK_BUTTON:
+		if (direction == Direction::IN) {
+			return 0;
+		}
+		break;
+	case BlockType::LIGHT:
+		if (direction == Direction::OUT) {
+			return 0;
+		}
+		break;
+	default:
+		break;
+	}
+	std::optional<connection_end_id_t> port = direction == Direction::IN ? block->getInputConnectionId(portPosition) : block->getOutputConnectionId(portPosition);
+	if (!port) {
+		return std::nullopt;
+	}
+	return port.value();
+}
+
+// true if checkToCreateExternalConnections can find anything for the block at position
+bool Evaluator::isICPort(const CircuitBlockData* circuitBlockData, const BlockContainer* blockContainer, Position position) const {
+	if (!circuitBlockData) {
+		return true;
+	}
+	auto hasPort = [circuitBlockData](Position portPosition) {
+		auto connectionIds = circuitBlockData->getConnectionPositionToId(portPosition);
+		return connectionIds.first != connectionIds.second;
+	};
+	if (hasPort(position)) {
+		return true;
+	}
+	const Block* block = blockContainer->getBlock(position);
+	if (!block) {
+		return true;
+	}
+	const BlockData* blockData = blockDataManager.getBlockData(block->type());
+	if (!blockData || blockData->isDefaultData()) {
+		return false;
+	}
+	for (const auto& [connectionId, connectionOffset] : blockData->getConnections()) {
+		if (hasPort(block->getPosition() + connectionOffset.first)) {
+			return true;
+		}
+	}
+	return false;
+}
+
 void Evaluator::edit_removeConnection(SimPauseGuard& pauseGuard, eval_circuit_id_t evalCircuitId, DiffCache& diffCache, const BlockContainer* blockContainer, Position outputBlockPosition, Position outputPosition, Position inputBlockPosition, Position inputPosition) {
 	std::optional<EvalConnectionPoint> outputPoint = getConnectionPoint(evalCircuitId, blockContainer, outputPosition, Direction::OUT);
 	if (!outputPoint.has_value()) {
@@ -293,10 +701,10 @@ void Evaluator::removeCircuitIO(const DataUpdateEventManager::EventData* data) {
 	Position position = std::get<2>(dataValue);
 
 	circuit_id_t circuitId = circuitBlockDataManager.getCircuitId(blockType);
-	SimPauseGuard pauseGuard = evalSimulator.beginEdit();
-	removeDependentInterCircuitConnections(pauseGuard, { circuitId, connectionEndId });
-	evalSimulator.endEdit(pauseGuard);
-	processDirtyNodes();
+	compiledCircuitCache.invalidate(circuitId);
+	beginEditBatch();
+	removeDependentInterCircuitConnections(*editBatchPauseGuard, { circuitId, connectionEndId });
+	commitEditBatch();
 }
 
 void Evaluator::setCircuitIO(const DataUpdateEventManager::EventData* data) {
@@ -314,17 +722,21 @@ void Evaluator::setCircuitIO(const DataUpdateEventManager::EventData* data) {
 		logError("Circuit ID for BlockType {} is 0, cannot set IO", "Evaluator::setCircuitIO", blockType);
 		return;
 	}
-	SimPauseGuard pauseGuard = evalSimulator.beginEdit();
+	compiledCircuitCache.invalidate(circuitId);
+	beginEditBatch();
+	SimPauseGuard& pauseGuard = *editBatchPauseGuard;
 	removeDependentInterCircuitConnections(pauseGuard, { circuitId, connectionEndId });
 	// get the new position
 	CircuitBlockData* circuitBlockData = circuitBlockDataManager.getCircuitBlockData(circuitId);
 	if (!circuitBlockData) {
 		logError("CircuitBlockData for Circuit ID {} not found", "Evaluator::setCircuitIO", circuitId);
+		commitEditBatch();
 		return;
 	}
 	const Position* position = circuitBlockData->getConnectionIdToPosition(connectionEndId);
 	if (!position) {
 		logError("Position for connection end ID {} not found in CircuitBlockData for Circuit ID {}", "Evaluator::setCircuitIO", connectionEndId, circuitId);
+		commitEditBatch();
 		return;
 	}
 	// use checkToCreateExternalConnections
@@ -339,8 +751,7 @@ void Evaluator::setCircuitIO(const DataUpdateEventManager::EventData* data) {
 		}
 		checkToCreateExternalConnections(pauseGuard, evalCircuitId, *position);
 	}
-	evalSimulator.endEdit(pauseGuard);
-	processDirtyNodes();
+	commitEditBatch();
 }
 
 std::optional<connection_port_id_t> Evaluator::getPortId(const circuit_id_t circuitId, const Position blockPosition, const Position portPosition, Direction direction) const {
@@ -1095,6 +1506,18 @@ std::vector<logic_state_t> Evaluator::getStatesFromSimulatorIds(const std::vecto
 	return evalSimulator.getStatesFromSimulatorIds(simulatorIds);
 }
 
+state_change_feed_id_t Evaluator::subscribeStateChanges() {
+	return evalSimulator.subscribeStateChanges();
+}
+
+void Evaluator::unsubscribeStateChanges(state_change_feed_id_t feed) {
+	evalSimulator.unsubscribeStateChanges(feed);
+}
+
+std::vector<simulator_id_t> Evaluator::takeChangedSimulatorIds(state_change_feed_id_t feed) {
+	return evalSimulator.takeChangedSimulatorIds(feed);
+}
+
 void Evaluator::connectListener(
 	void* object,
 	const Address& address,
@@ -1119,7 +1542,5 @@ void Evaluator::connectListener(
 }
 
 void Evaluator::waitForSprintComplete() {
-	while (evalConfig.getSprintCount() > 0) {
-		std::this_thread::sleep_for(std::chrono::milliseconds(1));
-	}
+	evalConfig.waitForSprintComplete();
 }
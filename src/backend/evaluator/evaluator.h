@@ -96,14 +96,55 @@ public:
 		waitForSprintComplete();
 	}
 	void tickStep() { tickStep (1); }
+	// Undo or redo up to nTicks of the steps kept by the history and return how many were stepped. A step is a tick
+	// or the states set between two ticks. Steps stepped back can be stepped forward again until the simulation
+	// ticks or a state is set.
+	unsigned int stepBack(unsigned int nTicks);
+	unsigned int stepForward(unsigned int nTicks);
+	// the number of steps kept to step back through, 0 (the default) records nothing. Edits clear the history
+	void setHistoryDepth(unsigned int depth) { evalConfig.setHistoryDepth(depth); }
+	unsigned int getHistoryDepth() const { return evalConfig.getHistoryDepth(); }
 	void setRealistic(bool realistic) { evalConfig.setRealistic(realistic); }
 	bool isRealistic() const { return evalConfig.isRealistic(); }
+	void setEvaluationMode(EvaluationMode mode) { evalConfig.setEvaluationMode(mode); }
+	EvaluationMode getEvaluationMode() const { return evalConfig.getEvaluationMode(); }
+	void setThreadCount(unsigned int count) { evalConfig.setThreadCount(count); }
+	unsigned int getThreadCount() const { return evalConfig.getThreadCount(); }
+	void setThreadPinning(bool enabled) { evalConfig.setThreadPinning(enabled); }
+	void setICInstancing(bool enabled) { evalConfig.setICInstancing(enabled); }
+	bool isICInstancing() const { return evalConfig.isICInstancingEnabled(); }
+	void setConstantFolding(bool enabled) { evalConfig.setConstantFolding(enabled); }
+	bool isConstantFolding() const { return evalConfig.isConstantFoldingEnabled(); }
+	void setGateMerging(bool enabled) { evalConfig.setGateMerging(enabled); }
+	bool isGateMerging() const { return evalConfig.isGateMergingEnabled(); }
 	void setTickrate(double tickrate) { evalConfig.setTargetTickrate(tickrate); }
 	double getTickrate() const { return evalConfig.getTargetTickrate(); }
 	void setUseTickrate(bool useTickrate) { evalConfig.setTickrateLimiter(useTickrate); }
 	bool getUseTickrate() const { return evalConfig.isTickrateLimiterEnabled(); }
 	double getRealTickrate() const { return evalSimulator.getAverageTickrate(); }
 	void makeEdit(DifferenceSharedPtr difference, circuit_id_t circuitId);
+	// Edits made between beginEditBatch and commitEditBatch share one simulator pause, one optimizer pass and one
+	// simulator mapping update. Batches nest, the outermost commit applies them. Both calls must come from the editing thread.
+	// Calls that read the circuit or its states wait for the commit, so the editing thread must not make them in between.
+	void beginEditBatch();
+	void commitEditBatch();
+	// renumbers the simulator ids so connected gates sit next to each other in memory
+	void optimizeSimulatorLayout();
+	// renumbers the simulator ids densely. also runs on its own after an edit once most ids are free
+	void compactSimulatorIds();
+	// copies the simulated circuit into a batch of laneCount independent lanes, addressed by the simulator ids
+	// from getBlockSimulatorIds and getPinSimulatorIds (see BatchedSimulator)
+	BatchedSimulator makeBatchedSimulator(unsigned int laneCount);
+	// captures every simulated state. Restoring only works on an evaluator simulating the same circuit with the
+	// same simulator ids, e.g. one loaded from the same file, and returns false otherwise
+	SimulatorSnapshot takeSnapshot();
+	bool restoreSnapshot(const SimulatorSnapshot& snapshot);
+	// Streams the output states of the blocks at addresses to a waveform file, one sample per tick, until
+	// stopWaveformCapture. The address of an IC watches every block inside it. Every signal follows the block
+	// at its position through later edits and records undefined while no block with an output is there.
+	bool startWaveformCapture(const std::filesystem::path& path, const std::vector<Address>& addresses, WaveformFormat format = WaveformFormat::VCD);
+	// waits until everything captured is written
+	void stopWaveformCapture();
 	logic_state_t getState(const Address& address);
 	bool getBoolState(const Address& address) { return toBool(getState(address)); };
 	void setState(const Address& address, logic_state_t state);
@@ -133,6 +174,12 @@ public:
 	std::vector<simulator_id_t> getBlockSimulatorIds(const Address& addressOrigin, const std::vector<Position>& positions) const;
 	std::vector<simulator_id_t> getPinSimulatorIds(const Address& addressOrigin, const std::vector<Position>& positions) const;
 	std::vector<logic_state_t> getStatesFromSimulatorIds(const std::vector<simulator_id_t>& simulatorIds) const;
+	// Instead of reading every visible simulator id each frame, a consumer can subscribe to a feed and read only
+	// the ids that changed since its last takeChangedSimulatorIds, merged over all ticks in between. The first
+	// take, and the first after an edit or reset, returns every id. A feed must be read from one thread at a time.
+	state_change_feed_id_t subscribeStateChanges();
+	void unsubscribeStateChanges(state_change_feed_id_t feed);
+	std::vector<simulator_id_t> takeChangedSimulatorIds(state_change_feed_id_t feed);
 
 	void connectListener(
 		void* object,
@@ -157,15 +204,31 @@ private:
 	EvalConfig evalConfig;
 	IdProvider<middle_id_t> middleIdProvider;
 	EvalSimulator evalSimulator;
+	CompiledCircuitCache compiledCircuitCache;
 
 	bool changedICs = false;
+	unsigned int editBatchDepth = 0;
+	std::unique_ptr<SimPauseGuard> editBatchPauseGuard;
+	std::unique_lock<std::shared_mutex> editBatchLock; // simMutex, held from beginEditBatch to commitEditBatch
 
+	std::shared_ptr<WaveformRecorder> waveformRecorder;
+	std::vector<EvalPosition> waveformPositions; // the watched block of every signal of waveformRecorder
+
+	void makeEdit(DifferenceSharedPtr difference, circuit_id_t circuitId, DiffCache& diffCache);
+	void preloadICDefinitions(DiffCache& diffCache, DifferenceSharedPtr difference);
 	void makeEditInPlace(SimPauseGuard& pauseGuard, eval_circuit_id_t evalCircuitId, DifferenceSharedPtr difference, DiffCache& diffCache);
+	void applyModification(SimPauseGuard& pauseGuard, eval_circuit_id_t evalCircuitId, DiffCache& diffCache, const BlockContainer* blockContainer, const Difference::Modification& modification);
+	static GateType getGateType(BlockType type);
 
 	void edit_removeBlock(SimPauseGuard& pauseGuard, eval_circuit_id_t evalCircuitId, DiffCache& diffCache, Position position, Orientation orientation, BlockType type);
 	void edit_deleteICContents(SimPauseGuard& pauseGuard, eval_circuit_id_t evalCircuitId);
 	void edit_placeBlock(SimPauseGuard& pauseGuard, eval_circuit_id_t evalCircuitId, DiffCache& diffCache, Position position, Orientation orientation, BlockType type);
 	void edit_placeIC(SimPauseGuard& pauseGuard, eval_circuit_id_t evalCircuitId, DiffCache& diffCache, Position position, Orientation orientation, circuit_id_t circuitId);
+	SharedICTemplate getICTemplate(DiffCache& diffCache, circuit_id_t circuitId);
+	SharedICTemplate compileICTemplate(circuit_id_t circuitId, DifferenceSharedPtr difference) const;
+	void instantiateICTemplate(SimPauseGuard& pauseGuard, eval_circuit_id_t evalCircuitId, DiffCache& diffCache, const ICTemplate& icTemplate);
+	std::optional<connection_port_id_t> getGatePortId(const BlockContainer* blockContainer, Position portPosition, Direction direction) const;
+	bool isICPort(const CircuitBlockData* circuitBlockData, const BlockContainer* blockContainer, Position position) const;
 	void edit_removeConnection(SimPauseGuard& pauseGuard, eval_circuit_id_t evalCircuitId, DiffCache& diffCache, const BlockContainer* blockContainer, Position outputBlockPosition, Position outputPosition, Position inputBlockPosition, Position inputPosition);
 	void edit_createConnection(SimPauseGuard& pauseGuard, eval_circuit_id_t evalCircuitId, DiffCache& diffCache, const BlockContainer* blockContainer, Position outputBlockPosition, Position outputPosition, Position inputBlockPosition, Position inputPosition);
 	void edit_moveBlock(SimPauseGuard& pauseGuard, eval_circuit_id_t evalCircuitId, DiffCache& diffCache, Position curPosition, Orientation curOrientation, Position newPosition, Orientation newOrientation);
@@ -182,6 +245,11 @@ private:
 	std::optional<connection_port_id_t> getPortId(const circuit_id_t circuitId, const Position blockPosition, const Position portPosition, Direction direction) const;
 	std::optional<connection_port_id_t> getPortId(const BlockContainer* blockContainer, const Position blockPosition, const Position portPosition, Direction direction) const;
 	std::optional<EvalConnectionPoint> getConnectionPoint(const eval_circuit_id_t evalCircuitId, const Position portPosition, Direction direction) const;
+	// adds every block of the eval circuit and of the ICs inside it, named prefix.position
+	void collectWaveformSignals(eval_circuit_id_t evalCircuitId, const std::string& prefix, std::vector<std::string>& names, std::vector<EvalPosition>& positions) const;
+	std::vector<simulator_id_t> getWaveformSimulatorIds(const std::vector<EvalPosition>& positions) const;
+	// points the running capture at the current simulator ids of its blocks, called after every committed edit
+	void updateWaveformSimulatorIds(SimPauseGuard& pauseGuard);
 	std::optional<EvalConnectionPoint> getConnectionPoint(const eval_circuit_id_t evalCircuitId, const BlockContainer* blockContainer, const Position portPosition, Direction direction) const;
 	std::optional<EvalConnectionPoint> getConnectionPoint(
 		const eval_circuit_id_t evalCircuitId,
@@ -55,6 +55,28 @@ public:
 		}
 	}
 
+	// Coalesces the differences applied until the matching commitEditBatch into one edit per evaluator.
+	// Evaluators created inside the batch apply their edits right away.
+	void beginEditBatch() {
+		if (editBatchDepth++ != 0) return;
+		for (auto& [id, evaluator] : evaluators) {
+			evaluator->beginEditBatch();
+			batchedEvaluators.push_back(evaluator);
+		}
+	}
+	void commitEditBatch() {
+		if (editBatchDepth == 0) {
+			logError("commitEditBatch called without a matching beginEditBatch", "EvaluatorManager::commitEditBatch");
+			return;
+		}
+		if (--editBatchDepth != 0) return;
+		std::vector<SharedEvaluator> evaluatorsToCommit = std::move(batchedEvaluators);
+		batchedEvaluators.clear();
+		for (SharedEvaluator& evaluator : evaluatorsToCommit) {
+			evaluator->commitEditBatch();
+		}
+	}
+
 private:
 	evaluator_id_t getNewEvaluatorId() { return ++lastId; }
 
@@ -62,6 +84,24 @@ private:
 	
 	evaluator_id_t lastId = 0;
 	std::map<evaluator_id_t, SharedEvaluator> evaluators;
+	unsigned int editBatchDepth = 0;
+	std::vector<SharedEvaluator> batchedEvaluators; // kept alive until the batch is committed
+};
+
+// Batches every difference applied while it is alive, see EvaluatorManager::beginEditBatch
+class EvaluatorEditBatch {
+public:
+	explicit EvaluatorEditBatch(EvaluatorManager* evaluatorManager) : evaluatorManager(evaluatorManager) {
+		evaluatorManager->beginEditBatch();
+	}
+	EvaluatorEditBatch(const EvaluatorEditBatch&) = delete;
+	EvaluatorEditBatch& operator=(const EvaluatorEditBatch&) = delete;
+	~EvaluatorEditBatch() {
+		evaluatorManager->commitEditBatch();
+	}
+
+private:
+	EvaluatorManager* evaluatorManager;
 };
 
 #endif /* evaluatorManager_h */
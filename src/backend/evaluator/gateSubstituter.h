@@ -75,6 +75,9 @@ public:
 		}
 		replacer.addGate(pauseGuard, gateType, gateId); // this may need to be conditional in the future if we add more conditional gates
 	}
+	void addDelayGate(SimPauseGuard& pauseGuard, unsigned int delayTicks, const middle_id_t gateId) {
+		replacer.addDelayGate(pauseGuard, delayTicks, gateId);
+	}
 	void removeGate(SimPauseGuard& pauseGuard, const middle_id_t gateId) {
 		replacer.removeGate(pauseGuard, gateId);
 		deleteTrackedGate(gateId);
@@ -106,6 +109,33 @@ public:
 	inline void endEdit(SimPauseGuard& pauseGuard) {
 		replacer.endEdit(pauseGuard);
 	}
+	inline void renumberForLocality(SimPauseGuard& pauseGuard) {
+		replacer.renumberForLocality(pauseGuard);
+	}
+	inline void compactSimulatorIds(SimPauseGuard& pauseGuard) {
+		replacer.compactSimulatorIds(pauseGuard);
+	}
+	inline BatchedSimulator makeBatchedSimulator(SimPauseGuard& pauseGuard, unsigned int laneCount) {
+		return replacer.makeBatchedSimulator(pauseGuard, laneCount);
+	}
+	inline void clearState(SimPauseGuard& pauseGuard) {
+		replacer.clearState(pauseGuard);
+	}
+	inline SimulatorSnapshot takeSnapshot(SimPauseGuard& pauseGuard) {
+		return replacer.takeSnapshot(pauseGuard);
+	}
+	inline bool restoreSnapshot(SimPauseGuard& pauseGuard, const SimulatorSnapshot& snapshot) {
+		return replacer.restoreSnapshot(pauseGuard, snapshot);
+	}
+	inline unsigned int stepBack(SimPauseGuard& pauseGuard, unsigned int nTicks) {
+		return replacer.stepBack(pauseGuard, nTicks);
+	}
+	inline unsigned int stepForward(SimPauseGuard& pauseGuard, unsigned int nTicks) {
+		return replacer.stepForward(pauseGuard, nTicks);
+	}
+	inline void setWaveformRecorder(SimPauseGuard& pauseGuard, std::shared_ptr<WaveformRecorder> recorder) {
+		replacer.setWaveformRecorder(pauseGuard, std::move(recorder));
+	}
 
 	inline logic_state_t getState(EvalConnectionPoint point) const {
 		return replacer.getState(point);
@@ -119,6 +149,15 @@ public:
 	inline std::vector<logic_state_t> getStatesFromSimulatorIds(const std::vector<simulator_id_t>& simulatorIds) const {
 		return replacer.getStatesFromSimulatorIds(simulatorIds);
 	}
+	inline state_change_feed_id_t subscribeStateChanges() {
+		return replacer.subscribeStateChanges();
+	}
+	inline void unsubscribeStateChanges(state_change_feed_id_t feed) {
+		replacer.unsubscribeStateChanges(feed);
+	}
+	inline std::vector<simulator_id_t> takeChangedSimulatorIds(state_change_feed_id_t feed) {
+		return replacer.takeChangedSimulatorIds(feed);
+	}
 	inline std::vector<SimulatorStateAndPinSimId> getSimulatorIds(const std::vector<EvalConnectionPoint>& points) const {
 		return replacer.getSimulatorIds(points);
 	}
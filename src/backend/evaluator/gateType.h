@@ -17,6 +17,7 @@ enum class GateType {
 	JUNCTION = 12,
 	TRISTATE_BUFFER = 13,
 	TRISTATE_BUFFER_INVERTED = 14,
+	DELAY = 15, // one tick buffer, see SimulatorOptimizer::addDelayGate for longer delays
 };
 
 #endif /* gateType_h */
@@ -44,6 +44,20 @@ public:
 		lastId = 0;
 		unusedIds.clear();
 	}
+	// replaces the provider state so that exactly usedIds are in use
+	inline void setUsedIds(const std::vector<T>& usedIds) {
+		unusedIds.clear();
+		lastId = usedIds.empty() ? 0 : *std::max_element(usedIds.begin(), usedIds.end()) + 1;
+		std::vector<bool> isUsed(lastId, false);
+		for (T id : usedIds) {
+			isUsed[id] = true;
+		}
+		for (T id = 0; id < lastId; ++id) {
+			if (!isUsed[id]) {
+				unusedIds.insert(id);
+			}
+		}
+	}
 	inline std::vector<T> getUsedIds() const {
 		std::vector<T> usedIds;
 		for (T id = 0; id < lastId; ++id) {
@@ -30,7 +30,143 @@ LogicSimulator::~LogicSimulator() {
 	}
 }
 
-void LogicSimulator::clearState() { }
+void LogicSimulator::clearState() {
+	std::scoped_lock lk(statesBMutex, statesAMutex);
+	beginStatesWrite();
+	const bool realistic = evalConfig.isRealistic();
+	auto resetGates = [&](auto& gates) {
+		for (auto& gate : gates) {
+			gate.resetState(realistic, statesA);
+			gate.resetState(realistic, statesB);
+		}
+	};
+	resetGates(andGates);
+	resetGates(xorGates);
+	resetGates(junctions);
+	resetGates(buffers);
+	resetGates(singleBuffers);
+	resetGates(tristateBuffers);
+	resetGates(constantGates);
+	resetGates(constantResetGates);
+	resetGates(copySelfOutputGates);
+	doubleTickJunctions();
+	endStatesWrite();
+	needsFullEvaluation = true;
+	history.clear();
+	externalChangesBefore.clear();
+	stateChangeFeeds.markAllChanged();
+}
+
+SimulatorSnapshot LogicSimulator::takeSnapshot() const {
+	SimulatorSnapshot snapshot;
+	snapshot.netlistHash = getNetlistHash();
+	snapshot.states = std::make_shared<const std::vector<logic_state_t>>(statesA);
+	std::vector<SimulatorSnapshot::DelayLine> delayLines;
+	for (const auto& gate : buffers) {
+		if (!gate.delayLine.empty()) {
+			delayLines.push_back({ gate.getId(), gate.delayHead, gate.delayLine });
+		}
+	}
+	snapshot.delayLines = std::make_shared<const std::vector<SimulatorSnapshot::DelayLine>>(std::move(delayLines));
+	return snapshot;
+}
+
+bool LogicSimulator::restoreSnapshot(const SimulatorSnapshot& snapshot) {
+	if (!snapshot.isValid() || snapshot.states->size() != statesA.size() || snapshot.netlistHash != getNetlistHash()) {
+		logError("The snapshot was taken from a different circuit", "LogicSimulator::restoreSnapshot");
+		return false;
+	}
+	if (snapshot.delayLines) {
+		for (const auto& delayLine : *snapshot.delayLines) {
+			const GateLocation* location = findGateLocation(delayLine.id);
+			if (!location || location->gateType != SimGateType::BUFFER ||
+				buffers[location->gateIndex].delayLine.size() != delayLine.states.size() || delayLine.delayHead >= delayLine.states.size()) {
+				logError("The snapshot was taken from a different circuit", "LogicSimulator::restoreSnapshot");
+				return false;
+			}
+		}
+	}
+
+	std::scoped_lock lk(statesBMutex, statesAMutex);
+	beginStatesWrite();
+	std::copy(snapshot.states->begin(), snapshot.states->end(), statesA.begin());
+	std::copy(snapshot.states->begin(), snapshot.states->end(), statesB.begin());
+	if (snapshot.delayLines) {
+		for (const auto& delayLine : *snapshot.delayLines) {
+			BufferGate& gate = buffers[findGateLocation(delayLine.id)->gateIndex];
+			gate.delayLine = delayLine.states;
+			gate.delayHead = delayLine.delayHead;
+		}
+	}
+	endStatesWrite();
+	needsFullEvaluation = true;
+	history.clear();
+	// external changes queued before the snapshot must not end up in a step over the restored states
+	externalChangesBefore.clear();
+	stateChangeFeeds.markAllChanged();
+	return true;
+}
+
+namespace {
+	constexpr std::uint64_t fnvOffsetBasis = 14695981039346656037ull;
+	constexpr std::uint64_t fnvPrime = 1099511628211ull;
+
+	inline void hashValue(std::uint64_t& hash, std::uint64_t value) {
+		for (unsigned int i = 0; i < 8; ++i) {
+			hash ^= (value >> (i * 8)) & 0xff;
+			hash *= fnvPrime;
+		}
+	}
+
+	inline void hashRange(std::uint64_t& hash, const std::pair<const simulator_id_t*, const simulator_id_t*>& range) {
+		hashValue(hash, range.second - range.first);
+		for (const simulator_id_t* it = range.first; it != range.second; ++it) hashValue(hash, *it);
+	}
+}
+
+std::uint64_t LogicSimulator::getNetlistHash() const {
+	// every gate is hashed on its own and the hashes are summed, so the order of the gate vectors does not matter
+	std::uint64_t gateHashSum = 0;
+	auto addGate = [&](std::uint64_t kind, simulator_id_t id, std::uint64_t parameter, const auto&... inputRanges) {
+		std::uint64_t hash = fnvOffsetBasis;
+		hashValue(hash, kind);
+		hashValue(hash, id);
+		hashValue(hash, parameter);
+		(hashRange(hash, inputRanges), ...);
+		gateHashSum += hash;
+	};
+
+	CompiledGateList andList, xorList, junctionList, tristateList;
+	compileGateLists(andList, xorList, junctionList, tristateList);
+	const CompiledGateList* lists[] = { &andList, &xorList, &junctionList, &tristateList };
+	for (std::uint64_t kind = 0; kind < 4; ++kind) {
+		const CompiledGateList& list = *lists[kind];
+		for (size_t i = 0; i < list.size(); ++i) {
+			const std::pair<const simulator_id_t*, const simulator_id_t*> inputs { list.rangeBegin(i, 0), list.rangeEnd(i, 0) };
+			if (list.getRangesPerGate() == 2) {
+				addGate(kind, list.outputId(i), list.getFlags(i), inputs, std::make_pair(list.rangeBegin(i, 1), list.rangeEnd(i, 1)));
+			} else {
+				addGate(kind, list.outputId(i), list.getFlags(i), inputs);
+			}
+		}
+	}
+	for (const auto& gate : constantGates) addGate(4, gate.getId(), static_cast<std::uint64_t>(gate.outputState));
+	for (const auto& gate : constantResetGates) addGate(5, gate.getId(), static_cast<std::uint64_t>(gate.outputState));
+	for (const auto& gate : copySelfOutputGates) addGate(6, gate.getId(), 0);
+	for (const auto& gate : buffers) {
+		const std::optional<simulator_id_t> input = gate.getInput();
+		addGate(7, gate.getId(), (std::uint64_t(gate.extraDelayTicks) << 1) | gate.outputInverted, std::make_pair(input ? &input.value() : nullptr, input ? &input.value() + 1 : nullptr));
+	}
+	for (const auto& gate : singleBuffers) {
+		const std::optional<simulator_id_t> input = gate.getInput();
+		addGate(8, gate.getId(), gate.outputInverted, std::make_pair(input ? &input.value() : nullptr, input ? &input.value() + 1 : nullptr));
+	}
+
+	std::uint64_t hash = fnvOffsetBasis;
+	hashValue(hash, statesA.size());
+	hashValue(hash, gateHashSum);
+	return hash;
+}
 
 double LogicSimulator::getAverageTickrate() const {
 	if (!evalConfig.isRunning()) {
@@ -55,6 +191,9 @@ void LogicSimulator::simulationLoop() {
 	while (running) {
 		if (pauseRequest.load(std::memory_order_acquire)) {
 			averageTickrate.store(0.0, std::memory_order_release);
+			if (waveformRecorder) {
+				waveformRecorder->flush();
+			}
 			std::unique_lock<std::mutex> lk(cvMutex);
 			isPaused.store(true, std::memory_order_release);
 			cv.notify_all();
@@ -69,10 +208,12 @@ void LogicSimulator::simulationLoop() {
 		processPendingStateChanges();
 
 		bool didSprint = false;
-		while (running && !pauseRequest.load(std::memory_order_acquire) && evalConfig.consumeSprintTick()) {
+		while (running && !pauseRequest.load(std::memory_order_acquire) && evalConfig.getSprintCount() > 0) {
 			didSprint = true;
 			auto currentTime = clock::now();
 			tickOnce();
+			// only now, so waitForSprintComplete never returns while the last tick is still writing
+			evalConfig.consumeSprintTick();
 			updateEmaTickrate(currentTime, lastTickTime, isFirstTick);
 			if (pauseRequest.load(std::memory_order_acquire)) break;
 		}
@@ -95,6 +236,9 @@ void LogicSimulator::simulationLoop() {
 			}
 		} else if (!didSprint) {
 			averageTickrate.store(0.0, std::memory_order_release);
+			if (waveformRecorder) {
+				waveformRecorder->flush();
+			}
 			std::unique_lock lk(cvMutex);
 			cv.wait(lk, [&] {
 				std::lock_guard<std::mutex> stateLock(stateChangeQueueMutex);
@@ -131,12 +275,161 @@ inline void LogicSimulator::updateEmaTickrate(
 inline void LogicSimulator::tickOnce() {
 	std::unique_lock lkNext(statesBMutex);
 
-	threadPool.resetAndLoad(jobs);
-	threadPool.waitForCompletion();
+	const bool isRecordingHistory = history.isEnabled();
+	const bool isFeedingChanges = stateChangeFeeds.hasSubscribers();
+	if (isRecordingHistory) {
+		delaySlotsBefore.resize(buffers.size());
+		for (size_t i = 0; i < buffers.size(); ++i) {
+			if (!buffers[i].delayLine.empty()) delaySlotsBefore[i] = buffers[i].delayLine[buffers[i].delayHead];
+		}
+	}
 
-	for (auto& gate : junctions) gate.tick(statesB);
-	std::unique_lock lkCurEx(statesAMutex);
-	std::swap(statesA, statesB);
+	if (evaluationMode == EvaluationMode::LEVELIZED) {
+		tickLevelized();
+	} else if (evaluationMode == EvaluationMode::EVENT_DRIVEN && !needsFullEvaluation) {
+		tickEventDriven();
+	} else {
+		threadPool.resetAndLoad(jobs);
+		threadPool.waitForCompletion();
+
+		tickJunctions(statesB);
+		if (evaluationMode == EvaluationMode::EVENT_DRIVEN) {
+			collectChangedIds();
+		}
+	}
+	const std::vector<simulator_id_t>* tickChanges = nullptr;
+	if (isRecordingHistory || isFeedingChanges) {
+		tickChanges = &collectTickChanges();
+		if (isRecordingHistory) recordHistory(*tickChanges);
+	}
+	if (waveformRecorder) {
+		waveformRecorder->sample(statesB);
+	}
+	{
+		std::unique_lock lkCurEx(statesAMutex);
+		beginStatesWrite();
+		std::swap(statesA, statesB);
+		endStatesWrite();
+	}
+	// only once the new states can be read, a consumer taking the ids earlier could read the old state and miss the change
+	if (isFeedingChanges) stateChangeFeeds.addChanges(*tickChanges);
+}
+
+// the ids whose state the tick changed, statesA holds the states before the tick and statesB the states after it
+const std::vector<simulator_id_t>& LogicSimulator::collectTickChanges() {
+	// changedIds already holds exactly the ids the tick changed, so the cost follows the activity
+	if (evaluationMode == EvaluationMode::EVENT_DRIVEN) return changedIds;
+	tickChangedIds.clear();
+	const simulator_id_t idCount = static_cast<simulator_id_t>(statesA.size());
+	simulator_id_t id = 0;
+	// compares eight states at a time, most of them are equal in a quiet tick
+	for (; id + 8 <= idCount; id += 8) {
+		std::uint64_t before;
+		std::uint64_t after;
+		std::memcpy(&before, statesA.data() + id, sizeof(before));
+		std::memcpy(&after, statesB.data() + id, sizeof(after));
+		if (before == after) continue;
+		for (simulator_id_t i = id; i < id + 8; ++i) {
+			if (statesA[i] != statesB[i]) tickChangedIds.push_back(i);
+		}
+	}
+	for (; id < idCount; ++id) {
+		if (statesA[id] != statesB[id]) tickChangedIds.push_back(id);
+	}
+	return tickChangedIds;
+}
+
+void LogicSimulator::recordHistory(const std::vector<simulator_id_t>& tickChanges) {
+	history.beginTick();
+	for (simulator_id_t id : tickChanges) {
+		history.addStateChange(id, statesA[id], statesB[id]);
+	}
+	for (size_t i = 0; i < buffers.size(); ++i) {
+		const BufferGate& gate = buffers[i];
+		if (gate.delayLine.empty()) continue;
+		// the tick wrote the slot just before the head
+		const logic_state_t written = gate.delayLine[(gate.delayHead + gate.delayLine.size() - 1) % gate.delayLine.size()];
+		if (written != delaySlotsBefore[i]) history.addDelayLineChange(i, delaySlotsBefore[i], written);
+	}
+	history.finishTick();
+}
+
+// records the external changes since the last call as a step, so stepping back over them restores the states
+// from before they were set instead of mixing them into the tick before
+void LogicSimulator::recordExternalHistory() {
+	if (externalChangesBefore.empty()) return;
+	// an id set more than once keeps its first state before
+	std::stable_sort(externalChangesBefore.begin(), externalChangesBefore.end(), [](const StateChange& a, const StateChange& b) { return a.id < b.id; });
+	auto isFirstSet = [&](size_t i) { return i == 0 || externalChangesBefore[i - 1].id != externalChangesBefore[i].id; };
+	bool changed = false;
+	for (size_t i = 0; i < externalChangesBefore.size() && !changed; ++i) {
+		changed = isFirstSet(i) && externalChangesBefore[i].state != statesA[externalChangesBefore[i].id];
+	}
+	if (changed) {
+		history.beginTick();
+		for (size_t i = 0; i < externalChangesBefore.size(); ++i) {
+			const StateChange& change = externalChangesBefore[i];
+			if (isFirstSet(i) && change.state != statesA[change.id]) history.addStateChange(change.id, change.state, statesA[change.id]);
+		}
+		history.finishTick();
+	}
+	externalChangesBefore.clear();
+}
+
+void LogicSimulator::setWaveformRecorder(std::shared_ptr<WaveformRecorder> recorder) {
+	waveformRecorder = std::move(recorder);
+}
+
+unsigned int LogicSimulator::stepBack(unsigned int nTicks) {
+	std::scoped_lock lk(statesBMutex, statesAMutex);
+	beginStatesWrite();
+	auto applyState = [&](std::uint64_t id, logic_state_t state) {
+		statesA[id] = state;
+		statesB[id] = state;
+		tickChangedIds.push_back(static_cast<simulator_id_t>(id));
+	};
+	auto applyDelayLine = [&](std::uint64_t bufferIndex, logic_state_t state) {
+		BufferGate& gate = buffers[bufferIndex];
+		gate.delayLine[gate.delayHead] = state;
+	};
+	tickChangedIds.clear();
+	unsigned int steppedTicks = 0;
+	for (; steppedTicks < nTicks && history.getUndoableTicks() != 0; ++steppedTicks) {
+		// every delay line moved on by one slot in the tick
+		for (auto& gate : buffers) {
+			if (!gate.delayLine.empty()) gate.delayHead = (gate.delayHead + gate.delayLine.size() - 1) % gate.delayLine.size();
+		}
+		history.undoTick(applyState, applyDelayLine);
+	}
+	endStatesWrite();
+	needsFullEvaluation = true;
+	stateChangeFeeds.addChanges(tickChangedIds);
+	return steppedTicks;
+}
+
+unsigned int LogicSimulator::stepForward(unsigned int nTicks) {
+	std::scoped_lock lk(statesBMutex, statesAMutex);
+	beginStatesWrite();
+	auto applyState = [&](std::uint64_t id, logic_state_t state) {
+		statesA[id] = state;
+		statesB[id] = state;
+		tickChangedIds.push_back(static_cast<simulator_id_t>(id));
+	};
+	auto applyDelayLine = [&](std::uint64_t bufferIndex, logic_state_t state) {
+		BufferGate& gate = buffers[bufferIndex];
+		gate.delayLine[gate.delayHead] = state;
+	};
+	tickChangedIds.clear();
+	unsigned int steppedTicks = 0;
+	for (; steppedTicks < nTicks && history.redoTick(applyState, applyDelayLine); ++steppedTicks) {
+		for (auto& gate : buffers) {
+			if (!gate.delayLine.empty()) gate.delayHead = (gate.delayHead + 1) % gate.delayLine.size();
+		}
+	}
+	endStatesWrite();
+	needsFullEvaluation = true;
+	stateChangeFeeds.addChanges(tickChangedIds);
+	return steppedTicks;
 }
 
 void LogicSimulator::processPendingStateChanges() {
@@ -148,16 +441,23 @@ void LogicSimulator::processPendingStateChanges() {
 
 	if (!localQueue.empty()) {
 		std::scoped_lock lk(statesBMutex, statesAMutex);
+		simulator_id_t maxId = 0;
+		for (std::queue<StateChange> changes = localQueue; !changes.empty(); changes.pop()) {
+			maxId = std::max(maxId, changes.front().id);
+		}
+		extendDataVectors(maxId);
+
+		beginStatesWrite();
 		while (!localQueue.empty()) {
 			const StateChange& change = localQueue.front();
-
-			extendDataVectors(change.id);
-
+			recordExternalChange(change.id);
 			statesA[change.id] = change.state;
 			statesB[change.id] = change.state;
 			localQueue.pop();
 		}
-		for (auto& gate : junctions) gate.doubleTick(statesA, statesB);
+		doubleTickJunctions();
+		recordExternalHistory();
+		endStatesWrite();
 	}
 }
 
@@ -167,13 +467,14 @@ void LogicSimulator::setState(simulator_id_t id, logic_state_t st) {
 	std::unique_lock lkA(statesAMutex, std::try_to_lock);
 
 	if (lkB.owns_lock() && lkA.owns_lock()) {
-		if (statesA.size() <= id) {
-			statesA.resize(id + 1, logic_state_t::UNDEFINED);
-			statesB.resize(id + 1, logic_state_t::UNDEFINED);
-		}
+		extendDataVectors(id);
+		beginStatesWrite();
+		recordExternalChange(id);
 		statesA[id] = st;
 		statesB[id] = st;
-		for (auto& gate : junctions) gate.doubleTick(statesA, statesB);
+		doubleTickJunctions();
+		recordExternalHistory();
+		endStatesWrite();
 	} else {
 		std::lock_guard<std::mutex> lock(stateChangeQueueMutex);
 		pendingStateChanges.push({ id, st });
@@ -181,22 +482,52 @@ void LogicSimulator::setState(simulator_id_t id, logic_state_t st) {
 	}
 }
 
+template <typename Read>
+void LogicSimulator::readStates(Read&& read) const {
+	for (unsigned int attempt = 0; ; ++attempt) {
+		if (attempt < optimisticReadAttempts) {
+			activeReaders.fetch_add(1, std::memory_order_seq_cst);
+			const std::uint64_t sequence = statesSequence.load(std::memory_order_seq_cst);
+			if ((sequence & 1) == 0) {
+				read(publishedStates.load(std::memory_order_relaxed), publishedStateCount.load(std::memory_order_relaxed));
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (statesSequence.load(std::memory_order_relaxed) == sequence) {
+					activeReaders.fetch_sub(1, std::memory_order_release);
+					return;
+				}
+			}
+			activeReaders.fetch_sub(1, std::memory_order_release);
+		} else {
+			// the lock keeps the tick from swapping, activeReaders keeps edits from reallocating
+			std::shared_lock lk(statesAMutex);
+			activeReaders.fetch_add(1, std::memory_order_seq_cst);
+			if ((statesSequence.load(std::memory_order_seq_cst) & 1) == 0) {
+				read(statesA.data(), statesA.size());
+				activeReaders.fetch_sub(1, std::memory_order_release);
+				return;
+			}
+			activeReaders.fetch_sub(1, std::memory_order_release);
+		}
+		std::this_thread::yield();
+	}
+}
+
 logic_state_t LogicSimulator::getState(simulator_id_t id) const {
-	std::shared_lock lk(statesAMutex);
-	return statesA[id];
+	logic_state_t state = logic_state_t::UNDEFINED;
+	readStates([&](const logic_state_t* states, size_t stateCount) {
+		state = id < stateCount ? states[id] : logic_state_t::UNDEFINED;
+	});
+	return state;
 }
 
 std::vector<logic_state_t> LogicSimulator::getStates(const std::vector<simulator_id_t>& ids) const {
 	std::vector<logic_state_t> result(ids.size());
-	std::shared_lock lk(statesAMutex);
-	for (size_t i = 0; i < ids.size(); ++i) {
-		const size_t id = ids[i];
-		if (id < statesA.size()) {
-			result[i] = statesA[id];
-		} else {
-			result[i] = logic_state_t::UNDEFINED;
+	readStates([&](const logic_state_t* states, size_t stateCount) {
+		for (size_t i = 0; i < ids.size(); ++i) {
+			const size_t id = ids[i];
+			result[i] = id < stateCount ? states[id] : logic_state_t::UNDEFINED;
 		}
-	}
+	});
 	return result;
 }
 
@@ -308,6 +639,8 @@ simulator_id_t LogicSimulator::addGate(const GateType gateType) {
 		singleBuffers.back().resetState(evalConfig.isRealistic(), statesA);
 		singleBuffers.back().resetState(evalConfig.isRealistic(), statesB);
 		break;
+	case GateType::DELAY:
+		return addDelayGate(1);
 	case GateType::TICK_INPUT:
 		simulatorId = constantResetGates.size() == 0 ? simulatorIdProvider.getNewId() : simulatorIdProvider.getNewId(constantResetGates.back().getId());
 		extendDataVectors(simulatorId);
@@ -320,52 +653,44 @@ simulator_id_t LogicSimulator::addGate(const GateType gateType) {
 		logError("Cannot add gate of type NONE", "LogicSimulator::addGate");
 		return 0;
 	}
+	compiledDirty = true;
+	return simulatorId;
+}
+
+simulator_id_t LogicSimulator::addDelayGate(unsigned int delayTicks, bool outputInverted) {
+	if (delayTicks == 0) {
+		logError("A delay gate needs a delay of at least one tick", "LogicSimulator::addDelayGate");
+		delayTicks = 1;
+	}
+	simulator_id_t simulatorId = buffers.size() == 0 ? simulatorIdProvider.getNewId() : simulatorIdProvider.getNewId(buffers.back().getId());
+	extendDataVectors(simulatorId);
+	buffers.push_back({ simulatorId, outputInverted, delayTicks - 1 });
+	updateGateLocation(simulatorId, SimGateType::BUFFER, buffers.size() - 1);
+	buffers.back().resetState(evalConfig.isRealistic(), statesA);
+	buffers.back().resetState(evalConfig.isRealistic(), statesB);
+	compiledDirty = true;
 	return simulatorId;
 }
 
 void LogicSimulator::removeGate(simulator_id_t simulatorId) {
-	auto locationIt = gateLocations.find(simulatorId);
-	if (locationIt == gateLocations.end()) {
+	const GateLocation* location = findGateLocation(simulatorId);
+	if (!location) {
 		logError("Cannot remove gate: not found " + std::to_string(simulatorId), "LogicSimulator::removeGate");
 		return;
 	}
 
-	std::optional<std::vector<simulator_id_t>> outputIdsOpt = getOutputSimIdsFromGate(simulatorId);
-	if (!outputIdsOpt.has_value()) {
-		logError("Cannot remove gate: no output IDs found for simulator_id_t " + std::to_string(simulatorId), "LogicSimulator::removeGate");
-		return;
-	}
-	const auto& outputIds = outputIdsOpt.value();
-
-	for (const auto& outId : outputIds) {
-		auto depIt = outputDependencies.find(outId);
-		if (depIt != outputDependencies.end()) {
-			for (const auto& dependency : depIt->second) {
-				auto depLocIt = gateLocations.find(dependency.gateId);
-				if (depLocIt == gateLocations.end()) continue;
-
-				const auto depType = depLocIt->second.gateType;
-				const auto depIdx = depLocIt->second.gateIndex;
-				switch (depType) {
-				case SimGateType::AND:             if (depIdx < andGates.size())             andGates[depIdx].removeIdRefs(outId); break;
-				case SimGateType::XOR:             if (depIdx < xorGates.size())             xorGates[depIdx].removeIdRefs(outId); break;
-				case SimGateType::JUNCTION:        if (depIdx < junctions.size())            junctions[depIdx].removeIdRefs(outId); break;
-				case SimGateType::BUFFER:          if (depIdx < buffers.size())              buffers[depIdx].removeIdRefs(outId); break;
-				case SimGateType::SINGLE_BUFFER:   if (depIdx < singleBuffers.size())        singleBuffers[depIdx].removeIdRefs(outId); break;
-				case SimGateType::TRISTATE_BUFFER: if (depIdx < tristateBuffers.size())      tristateBuffers[depIdx].removeIdRefs(outId); break;
-				case SimGateType::CONSTANT:        if (depIdx < constantGates.size())        constantGates[depIdx].removeIdRefs(outId); break;
-				case SimGateType::CONSTANT_RESET:  if (depIdx < constantResetGates.size())   constantResetGates[depIdx].removeIdRefs(outId); break;
-				case SimGateType::COPY_SELF_OUTPUT:if (depIdx < copySelfOutputGates.size())  copySelfOutputGates[depIdx].removeIdRefs(outId); break;
-				}
-			}
-			outputDependencies.erase(depIt);
+	// every gate drives only its own id
+	if (simulatorId < outputDependencies.size()) {
+		for (const auto& dependency : outputDependencies[simulatorId]) {
+			visitGate(dependency.gateId, [&](auto& gate) { gate.removeIdRefs(simulatorId); });
 		}
-		simulatorIdProvider.releaseId(outId);
-		dirtySimulatorIds.push_back(outId);
+		outputDependencies[simulatorId].clear();
 	}
+	simulatorIdProvider.releaseId(simulatorId);
+	dirtySimulatorIds.push_back(simulatorId);
 
-	SimGateType gateType = locationIt->second.gateType;
-	size_t gateIndex = locationIt->second.gateIndex;
+	SimGateType gateType = location->gateType;
+	size_t gateIndex = location->gateIndex;
 
 	auto fixMovedIndex = [&](auto& vec) {
 		const size_t last = vec.size() - 1;
@@ -390,6 +715,7 @@ void LogicSimulator::removeGate(simulator_id_t simulatorId) {
 	}
 
 	removeGateLocation(simulatorId);
+	compiledDirty = true;
 }
 
 void LogicSimulator::makeConnection(simulator_id_t sourceId, connection_port_id_t sourcePort, simulator_id_t destinationId, connection_port_id_t destinationPort) {
@@ -413,272 +739,670 @@ void LogicSimulator::removeConnection(simulator_id_t sourceId, connection_port_i
 }
 
 void LogicSimulator::endEdit() {
-	for (auto& gate : junctions) gate.doubleTick(statesA, statesB);
+	{
+		std::scoped_lock lk(statesBMutex, statesAMutex);
+		beginStatesWrite();
+		doubleTickJunctions();
+		recordExternalHistory();
+		endStatesWrite();
+	}
 	regenerateJobs();
 }
 
-std::optional<simulator_id_t> LogicSimulator::getOutputPortId(simulator_id_t simId, connection_port_id_t portId) const {
-	auto locationIt = gateLocations.find(simId);
-	if (locationIt != gateLocations.end()) {
-		SimGateType gateType = locationIt->second.gateType;
-		size_t gateIndex = locationIt->second.gateIndex;
-
-		switch (gateType) {
-		case SimGateType::AND:
-			if (gateIndex < andGates.size()) {
-				return andGates[gateIndex].getIdOfOutputPort(portId);
-			}
-			break;
-		case SimGateType::XOR:
-			if (gateIndex < xorGates.size()) {
-				return xorGates[gateIndex].getIdOfOutputPort(portId);
-			}
-			break;
-		case SimGateType::JUNCTION:
-			if (gateIndex < junctions.size()) {
-				return junctions[gateIndex].getIdOfOutputPort(portId);
-			}
-			break;
-		case SimGateType::BUFFER:
-			if (gateIndex < buffers.size()) {
-				return buffers[gateIndex].getIdOfOutputPort(portId);
-			}
-			break;
-		case SimGateType::SINGLE_BUFFER:
-			if (gateIndex < singleBuffers.size()) {
-				return singleBuffers[gateIndex].getIdOfOutputPort(portId);
-			}
-			break;
-		case SimGateType::TRISTATE_BUFFER:
-			if (gateIndex < tristateBuffers.size()) {
-				return tristateBuffers[gateIndex].getIdOfOutputPort(portId);
-			}
-			break;
-		case SimGateType::CONSTANT:
-			if (gateIndex < constantGates.size()) {
-				return constantGates[gateIndex].getIdOfOutputPort(portId);
-			}
-			break;
-		case SimGateType::CONSTANT_RESET:
-			if (gateIndex < constantResetGates.size()) {
-				return constantResetGates[gateIndex].getIdOfOutputPort(portId);
-			}
-			break;
-		case SimGateType::COPY_SELF_OUTPUT:
-			if (gateIndex < copySelfOutputGates.size()) {
-				return copySelfOutputGates[gateIndex].getIdOfOutputPort(portId);
-			}
-			break;
+// Orders the gates by a breadth first walk over the (undirected) connection graph, starting at the
+// gates without inputs. Gates that talk to each other end up next to each other, so a job's
+// reads and writes stay within a small part of the state vectors.
+std::vector<simulator_id_t> LogicSimulator::getLocalityOrder() const {
+	const size_t idCount = statesA.size();
+	std::vector<std::uint32_t> adjacencyOffsets(idCount + 1, 0);
+	for (simulator_id_t outputId = 0; outputId < outputDependencies.size() && outputId < idCount; ++outputId) {
+		for (const auto& dependency : outputDependencies[outputId]) {
+			++adjacencyOffsets[outputId + 1];
+			++adjacencyOffsets[dependency.gateId + 1];
 		}
 	}
+	std::vector<std::uint8_t> hasInputs(idCount, 0);
+	for (size_t id = 0; id < idCount; ++id) {
+		adjacencyOffsets[id + 1] += adjacencyOffsets[id];
+	}
+	std::vector<simulator_id_t> adjacency(adjacencyOffsets.back());
+	std::vector<std::uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+	for (simulator_id_t outputId = 0; outputId < outputDependencies.size() && outputId < idCount; ++outputId) {
+		for (const auto& dependency : outputDependencies[outputId]) {
+			adjacency[fill[outputId]++] = dependency.gateId;
+			adjacency[fill[dependency.gateId]++] = outputId;
+			hasInputs[dependency.gateId] = 1;
+		}
+	}
+	// dependencies are kept in connection order, sort the neighbours so the order only depends on the circuit
+	for (size_t id = 0; id < idCount; ++id) {
+		std::sort(adjacency.begin() + adjacencyOffsets[id], adjacency.begin() + adjacencyOffsets[id + 1]);
+	}
 
-	return std::nullopt;
-}
+	std::vector<simulator_id_t> roots;
+	roots.reserve(gateCount);
+	for (simulator_id_t gateId = 0; gateId < gateLocations.size(); ++gateId) {
+		if (gateLocations[gateId].isGate()) roots.push_back(gateId);
+	}
+	std::sort(roots.begin(), roots.end(), [&](simulator_id_t a, simulator_id_t b) {
+		return hasInputs[a] != hasInputs[b] ? hasInputs[a] < hasInputs[b] : a < b;
+	});
 
-void LogicSimulator::addInputToGate(simulator_id_t simId, simulator_id_t inputId, connection_port_id_t portId) {
-	dirtySimulatorIds.push_back(inputId);
-	auto locationIt = gateLocations.find(simId);
-	if (locationIt != gateLocations.end()) {
-		SimGateType gateType = locationIt->second.gateType;
-		size_t gateIndex = locationIt->second.gateIndex;
-
-		switch (gateType) {
-		case SimGateType::AND:
-			if (gateIndex < andGates.size()) {
-				andGates[gateIndex].addInput(inputId, portId);
-				addOutputDependency(inputId, simId);
-			}
-			break;
-		case SimGateType::XOR:
-			if (gateIndex < xorGates.size()) {
-				xorGates[gateIndex].addInput(inputId, portId);
-				addOutputDependency(inputId, simId);
-			}
-			break;
-		case SimGateType::JUNCTION:
-			if (gateIndex < junctions.size()) {
-				junctions[gateIndex].addInput(inputId, portId);
-				addOutputDependency(inputId, simId);
+	std::vector<simulator_id_t> order;
+	order.reserve(roots.size());
+	std::vector<std::uint8_t> visited(idCount, 0);
+	for (simulator_id_t root : roots) {
+		if (visited[root]) continue;
+		visited[root] = 1;
+		size_t next = order.size();
+		order.push_back(root);
+		while (next < order.size()) {
+			const simulator_id_t id = order[next++];
+			for (std::uint32_t i = adjacencyOffsets[id]; i < adjacencyOffsets[id + 1]; ++i) {
+				const simulator_id_t neighbour = adjacency[i];
+				if (visited[neighbour] || !findGateLocation(neighbour)) continue;
+				visited[neighbour] = 1;
+				order.push_back(neighbour);
 			}
-			break;
-		case SimGateType::BUFFER:
-			if (gateIndex < buffers.size()) {
-				buffers[gateIndex].addInput(inputId, portId);
-				addOutputDependency(inputId, simId);
-			}
-			break;
-		case SimGateType::SINGLE_BUFFER:
-			if (gateIndex < singleBuffers.size()) {
-				singleBuffers[gateIndex].addInput(inputId, portId);
-				addOutputDependency(inputId, simId);
-			}
-			break;
-		case SimGateType::TRISTATE_BUFFER:
-			if (gateIndex < tristateBuffers.size()) {
-				tristateBuffers[gateIndex].addInput(inputId, portId);
-				addOutputDependency(inputId, simId);
-			}
-			break;
-		case SimGateType::CONSTANT:
-			if (gateIndex < constantGates.size()) {
-				constantGates[gateIndex].addInput(inputId, portId);
-				addOutputDependency(inputId, simId);
-			}
-			break;
-		case SimGateType::CONSTANT_RESET:
-			if (gateIndex < constantResetGates.size()) {
-				constantResetGates[gateIndex].addInput(inputId, portId);
-				addOutputDependency(inputId, simId);
-			}
-			break;
-		case SimGateType::COPY_SELF_OUTPUT:
-			if (gateIndex < copySelfOutputGates.size()) {
-				copySelfOutputGates[gateIndex].addInput(inputId, portId);
-				addOutputDependency(inputId, simId);
-			}
-			break;
 		}
-		return;
 	}
+	return order;
+}
+
+std::vector<simulator_id_t> LogicSimulator::renumberForLocality() {
+	// permute within the ids that are already in use so the id provider does not change
+	std::vector<simulator_id_t> order = getLocalityOrder();
+	std::vector<simulator_id_t> liveIds = order;
+	std::sort(liveIds.begin(), liveIds.end());
+	std::vector<simulator_id_t> oldToNew(statesA.size(), 0);
+	for (size_t i = 0; i < order.size(); ++i) {
+		oldToNew[order[i]] = liveIds[i];
+	}
+	remapSimulatorIds(oldToNew);
+	return oldToNew;
+}
 
-	logError("Gate not found for addInputToGate", "LogicSimulator::addInputToGate");
+// the order the tick jobs run the gates in, so each job writes a contiguous range of ids
+std::vector<simulator_id_t> LogicSimulator::getEvaluationOrder() const {
+	std::vector<simulator_id_t> order;
+	order.reserve(gateCount);
+	auto appendGates = [&](const auto& gates) {
+		for (const auto& gate : gates) order.push_back(gate.getId());
+	};
+	appendGates(andGates);
+	appendGates(xorGates);
+	appendGates(tristateBuffers);
+	appendGates(constantResetGates);
+	appendGates(copySelfOutputGates);
+	appendGates(junctions);
+	appendGates(buffers);
+	appendGates(singleBuffers);
+	appendGates(constantGates);
+	return order;
 }
 
-void LogicSimulator::removeInputFromGate(simulator_id_t simId, simulator_id_t inputId, connection_port_id_t portId) {
-	dirtySimulatorIds.push_back(inputId);
-	auto locationIt = gateLocations.find(simId);
-	if (locationIt != gateLocations.end()) {
-		SimGateType gateType = locationIt->second.gateType;
-		size_t gateIndex = locationIt->second.gateIndex;
-
-		switch (gateType) {
-		case SimGateType::AND:
-			if (gateIndex < andGates.size()) {
-				andGates[gateIndex].removeInput(inputId, portId);
-				removeOutputDependency(inputId, simId);
-			}
-			break;
-		case SimGateType::XOR:
-			if (gateIndex < xorGates.size()) {
-				xorGates[gateIndex].removeInput(inputId, portId);
-				removeOutputDependency(inputId, simId);
-			}
-			break;
-		case SimGateType::JUNCTION:
-			if (gateIndex < junctions.size()) {
-				junctions[gateIndex].removeInput(inputId, portId);
-				removeOutputDependency(inputId, simId);
-			}
-			break;
-		case SimGateType::BUFFER:
-			if (gateIndex < buffers.size()) {
-				buffers[gateIndex].removeInput(inputId, portId);
-				removeOutputDependency(inputId, simId);
-			}
-			break;
-		case SimGateType::SINGLE_BUFFER:
-			if (gateIndex < singleBuffers.size()) {
-				singleBuffers[gateIndex].removeInput(inputId, portId);
-				removeOutputDependency(inputId, simId);
-			}
-			break;
-		case SimGateType::TRISTATE_BUFFER:
-			if (gateIndex < tristateBuffers.size()) {
-				tristateBuffers[gateIndex].removeInput(inputId, portId);
-				removeOutputDependency(inputId, simId);
-			}
-			break;
-		case SimGateType::CONSTANT:
-			if (gateIndex < constantGates.size()) {
-				constantGates[gateIndex].removeInput(inputId, portId);
-				removeOutputDependency(inputId, simId);
-			}
-			break;
-		case SimGateType::CONSTANT_RESET:
-			if (gateIndex < constantResetGates.size()) {
-				constantResetGates[gateIndex].removeInput(inputId, portId);
-				removeOutputDependency(inputId, simId);
-			}
-			break;
-		case SimGateType::COPY_SELF_OUTPUT:
-			if (gateIndex < copySelfOutputGates.size()) {
-				copySelfOutputGates[gateIndex].removeInput(inputId, portId);
-				removeOutputDependency(inputId, simId);
+bool LogicSimulator::isFragmented() const {
+	const simulator_id_t idCount = simulatorIdProvider.getLastId();
+	return idCount > compactionMinIds && idCount > 2 * (gateCount + 1);
+}
+
+std::vector<simulator_id_t> LogicSimulator::compactIds() {
+	std::vector<simulator_id_t> order = getEvaluationOrder();
+	std::vector<simulator_id_t> oldToNew(statesA.size(), 0);
+	for (size_t i = 0; i < order.size(); ++i) {
+		oldToNew[order[i]] = static_cast<simulator_id_t>(i + 1);
+	}
+	logInfo("compacting {} simulator ids into {}", "LogicSimulator::compactIds", simulatorIdProvider.getLastId(), order.size() + 1);
+	remapSimulatorIds(oldToNew);
+	return oldToNew;
+}
+
+void LogicSimulator::remapSimulatorIds(const std::vector<simulator_id_t>& oldToNew) {
+	simulator_id_t newIdCount = 1; // id 0 stays reserved
+	std::vector<simulator_id_t> usedIds = { 0 };
+	for (simulator_id_t oldId = 1; oldId < oldToNew.size(); ++oldId) {
+		const simulator_id_t newId = oldToNew[oldId];
+		if (newId == 0) continue;
+		usedIds.push_back(newId);
+		newIdCount = std::max(newIdCount, newId + 1);
+		if (newId != oldId) {
+			// lets the evaluator send the new mapping to its listeners
+			dirtySimulatorIds.push_back(oldId);
+		}
+	}
+
+	{
+		std::scoped_lock lk(statesBMutex, statesAMutex);
+		beginStatesWrite();
+		waitForStateReaders();
+		std::vector<logic_state_t> newStatesA(newIdCount, logic_state_t::UNDEFINED);
+		std::vector<logic_state_t> newStatesB(newIdCount, logic_state_t::UNDEFINED);
+		newStatesA[0] = statesA[0];
+		newStatesB[0] = statesB[0];
+		for (simulator_id_t oldId = 1; oldId < oldToNew.size() && oldId < statesA.size(); ++oldId) {
+			if (oldToNew[oldId] == 0) continue;
+			newStatesA[oldToNew[oldId]] = statesA[oldId];
+			newStatesB[oldToNew[oldId]] = statesB[oldId];
+		}
+		statesA = std::move(newStatesA);
+		statesB = std::move(newStatesB);
+		endStatesWrite();
+	}
+	{
+		std::lock_guard<std::mutex> lock(stateChangeQueueMutex);
+		std::queue<StateChange> remappedChanges;
+		for (; !pendingStateChanges.empty(); pendingStateChanges.pop()) {
+			const StateChange& change = pendingStateChanges.front();
+			if (change.id < oldToNew.size() && oldToNew[change.id] != 0) {
+				remappedChanges.push({ oldToNew[change.id], change.state });
 			}
-			break;
 		}
-		return;
+		std::swap(remappedChanges, pendingStateChanges);
+	}
+	if (waveformRecorder) {
+		waveformRecorder->remapIds(oldToNew);
 	}
 
-	logError("Gate not found for removeInputFromGate", "LogicSimulator::removeInputFromGate");
+	// keep every gate vector sorted by id so that a job covers a contiguous slice of the states
+	gateLocations.assign(newIdCount, GateLocation());
+	gateCount = 0;
+	auto remapGates = [&](auto& gates, SimGateType gateType) {
+		for (auto& gate : gates) gate.remapIds(oldToNew);
+		std::sort(gates.begin(), gates.end(), [](const auto& a, const auto& b) { return a.getId() < b.getId(); });
+		for (size_t i = 0; i < gates.size(); ++i) updateGateLocation(gates[i].getId(), gateType, i);
+	};
+	remapGates(andGates, SimGateType::AND);
+	remapGates(xorGates, SimGateType::XOR);
+	remapGates(junctions, SimGateType::JUNCTION);
+	remapGates(buffers, SimGateType::BUFFER);
+	remapGates(singleBuffers, SimGateType::SINGLE_BUFFER);
+	remapGates(tristateBuffers, SimGateType::TRISTATE_BUFFER);
+	remapGates(constantGates, SimGateType::CONSTANT);
+	remapGates(constantResetGates, SimGateType::CONSTANT_RESET);
+	remapGates(copySelfOutputGates, SimGateType::COPY_SELF_OUTPUT);
+
+	std::vector<std::vector<GateDependency>> newOutputDependencies(newIdCount);
+	for (simulator_id_t outputId = 0; outputId < outputDependencies.size() && outputId < oldToNew.size(); ++outputId) {
+		if (oldToNew[outputId] == 0) continue;
+		std::vector<GateDependency>& newDependencies = newOutputDependencies[oldToNew[outputId]];
+		newDependencies.reserve(outputDependencies[outputId].size());
+		for (const auto& dependency : outputDependencies[outputId]) {
+			if (oldToNew[dependency.gateId] != 0) newDependencies.emplace_back(oldToNew[dependency.gateId]);
+		}
+	}
+	outputDependencies = std::move(newOutputDependencies);
+
+	simulatorIdProvider.setUsedIds(usedIds);
+	changedIds.clear();
+	externalChangedIds.clear();
+	// drop the capacity of the id indexed tables, compileGates rebuilds them at the new size
+	compiledGateRefs = {};
+	fanoutOffsets = {};
+	scheduledFlags = {};
+	compiledDirty = true;
+	needsFullEvaluation = true;
 }
 
-std::optional<std::vector<simulator_id_t>> LogicSimulator::getOutputSimIdsFromGate(simulator_id_t simId) const {
-	auto locationIt = gateLocations.find(simId);
-	if (locationIt == gateLocations.end()) return std::nullopt;
+std::optional<simulator_id_t> LogicSimulator::getOutputPortId(simulator_id_t simId, connection_port_id_t portId) const {
+	std::optional<simulator_id_t> outputId;
+	visitGate(simId, [&](const auto& gate) { outputId = gate.getIdOfOutputPort(portId); });
+	return outputId;
+}
 
-	SimGateType gateType = locationIt->second.gateType;
-	size_t gateIndex = locationIt->second.gateIndex;
+void LogicSimulator::addInputToGate(simulator_id_t simId, simulator_id_t inputId, connection_port_id_t portId) {
+	dirtySimulatorIds.push_back(inputId);
+	compiledDirty = true;
+	if (!visitGate(simId, [&](auto& gate) { gate.addInput(inputId, portId); })) {
+		logError("Gate not found for addInputToGate", "LogicSimulator::addInputToGate");
+		return;
+	}
+	addOutputDependency(inputId, simId);
+}
 
-	switch (gateType) {
-	case SimGateType::AND:
-		if (gateIndex < andGates.size()) return andGates[gateIndex].getOutputSimIds();
-		break;
-	case SimGateType::XOR:
-		if (gateIndex < xorGates.size()) return xorGates[gateIndex].getOutputSimIds();
-		break;
-	case SimGateType::JUNCTION:
-		if (gateIndex < junctions.size()) return junctions[gateIndex].getOutputSimIds();
-		break;
-	case SimGateType::BUFFER:
-		if (gateIndex < buffers.size()) return buffers[gateIndex].getOutputSimIds();
-		break;
-	case SimGateType::SINGLE_BUFFER:
-		if (gateIndex < singleBuffers.size()) return singleBuffers[gateIndex].getOutputSimIds();
-		break;
-	case SimGateType::TRISTATE_BUFFER:
-		if (gateIndex < tristateBuffers.size()) return tristateBuffers[gateIndex].getOutputSimIds();
-		break;
-	case SimGateType::CONSTANT:
-		if (gateIndex < constantGates.size()) return constantGates[gateIndex].getOutputSimIds();
-		break;
-	case SimGateType::CONSTANT_RESET:
-		if (gateIndex < constantResetGates.size()) return constantResetGates[gateIndex].getOutputSimIds();
-		break;
-	case SimGateType::COPY_SELF_OUTPUT:
-		if (gateIndex < copySelfOutputGates.size()) return copySelfOutputGates[gateIndex].getOutputSimIds();
-		break;
+void LogicSimulator::removeInputFromGate(simulator_id_t simId, simulator_id_t inputId, connection_port_id_t portId) {
+	dirtySimulatorIds.push_back(inputId);
+	compiledDirty = true;
+	if (!visitGate(simId, [&](auto& gate) { gate.removeInput(inputId, portId); })) {
+		logError("Gate not found for removeInputFromGate", "LogicSimulator::removeInputFromGate");
+		return;
 	}
-	return std::nullopt;
+	removeOutputDependency(inputId, simId);
 }
 
 void LogicSimulator::updateGateLocation(simulator_id_t gateId, SimGateType gateType, size_t gateIndex) {
+	if (gateLocations.size() <= gateId) {
+		gateLocations.resize(gateId + 1);
+	}
+	if (!gateLocations[gateId].isGate()) {
+		++gateCount;
+	}
 	gateLocations[gateId] = GateLocation(gateType, gateIndex);
 }
 
 void LogicSimulator::removeGateLocation(simulator_id_t gateId) {
-	gateLocations.erase(gateId);
+	if (gateId < gateLocations.size() && gateLocations[gateId].isGate()) {
+		gateLocations[gateId] = GateLocation();
+		--gateCount;
+	}
 }
 
 void LogicSimulator::addOutputDependency(simulator_id_t outputId, simulator_id_t dependentGateId) {
+	if (outputDependencies.size() <= outputId) {
+		outputDependencies.resize(outputId + 1);
+	}
 	outputDependencies[outputId].emplace_back(dependentGateId);
 }
 
 void LogicSimulator::removeOutputDependency(simulator_id_t outputId, simulator_id_t dependentGateId) {
-	auto it = outputDependencies.find(outputId);
-	if (it != outputDependencies.end()) {
-		auto& deps = it->second;
+	if (outputId < outputDependencies.size()) {
+		auto& deps = outputDependencies[outputId];
 		deps.erase(std::remove(deps.begin(), deps.end(), GateDependency(dependentGateId)), deps.end());
-		if (deps.empty()) {
-			outputDependencies.erase(it);
+	}
+}
+
+void LogicSimulator::compileGateLists(CompiledGateList& andList, CompiledGateList& xorList, CompiledGateList& junctionList, CompiledGateList& tristateList) const {
+	andList.reset(1, andGates.size());
+	for (const auto& gate : andGates) {
+		andList.addGate(
+			gate.getId(),
+			(gate.inputsInverted ? CompiledGateList::INPUTS_INVERTED : 0) | (gate.outputInverted ? CompiledGateList::OUTPUT_INVERTED : 0)
+		);
+		andList.addRange(gate.getInputs());
+	}
+	xorList.reset(1, xorGates.size());
+	for (const auto& gate : xorGates) {
+		xorList.addGate(gate.getId(), gate.outputInverted ? CompiledGateList::OUTPUT_INVERTED : 0);
+		xorList.addRange(gate.getInputs());
+	}
+	junctionList.reset(1, junctions.size());
+	for (const auto& gate : junctions) {
+		junctionList.addGate(gate.getId());
+		junctionList.addRange(gate.inputs);
+	}
+	// range 0 is the data inputs, range 1 the enable inputs
+	tristateList.reset(2, tristateBuffers.size());
+	for (const auto& gate : tristateBuffers) {
+		tristateList.addGate(gate.getId(), gate.enableInverted ? CompiledGateList::ENABLE_INVERTED : 0);
+		tristateList.addRange(gate.inputs);
+		tristateList.addRange(gate.enableInputs);
+	}
+}
+
+void LogicSimulator::compileGates() {
+	compileGateLists(compiledAndGates, compiledXorGates, compiledJunctions, compiledTristateBuffers);
+
+	// fanout of every id, used by the event driven scheduler
+	compiledGateRefs.assign(statesA.size(), CompiledGateRef());
+	for (size_t i = 0; i < compiledAndGates.size(); ++i) compiledGateRefs[compiledAndGates.outputId(i)] = { CompiledGateRef::Kind::AND, static_cast<std::uint32_t>(i) };
+	for (size_t i = 0; i < compiledXorGates.size(); ++i) compiledGateRefs[compiledXorGates.outputId(i)] = { CompiledGateRef::Kind::XOR, static_cast<std::uint32_t>(i) };
+	for (size_t i = 0; i < compiledTristateBuffers.size(); ++i) compiledGateRefs[compiledTristateBuffers.outputId(i)] = { CompiledGateRef::Kind::TRISTATE_BUFFER, static_cast<std::uint32_t>(i) };
+	for (size_t i = 0; i < compiledJunctions.size(); ++i) compiledGateRefs[compiledJunctions.outputId(i)] = { CompiledGateRef::Kind::JUNCTION, static_cast<std::uint32_t>(i) };
+
+	fanoutOffsets.assign(statesA.size() + 1, 0);
+	for (simulator_id_t outputId = 0; outputId < outputDependencies.size() && outputId < statesA.size(); ++outputId) {
+		fanoutOffsets[outputId + 1] = static_cast<std::uint32_t>(outputDependencies[outputId].size());
+	}
+	for (size_t id = 0; id < statesA.size(); ++id) {
+		fanoutOffsets[id + 1] += fanoutOffsets[id];
+	}
+	fanoutRefs.assign(fanoutOffsets.back(), CompiledGateRef());
+	for (simulator_id_t outputId = 0; outputId < outputDependencies.size() && outputId < statesA.size(); ++outputId) {
+		std::uint32_t next = fanoutOffsets[outputId];
+		for (const auto& dependency : outputDependencies[outputId]) {
+			if (dependency.gateId < compiledGateRefs.size()) fanoutRefs[next] = compiledGateRefs[dependency.gateId];
+			++next;
 		}
 	}
+
+	scheduledFlags.assign(statesA.size(), 0);
+	compiledDirty = false;
+	needsFullEvaluation = true;
+	levelizationDirty = true;
+}
+
+simulator_id_t LogicSimulator::getCompiledOutputId(CompiledGateRef ref) const {
+	switch (ref.kind) {
+	case CompiledGateRef::Kind::AND:             return compiledAndGates.outputId(ref.index);
+	case CompiledGateRef::Kind::XOR:             return compiledXorGates.outputId(ref.index);
+	case CompiledGateRef::Kind::TRISTATE_BUFFER: return compiledTristateBuffers.outputId(ref.index);
+	case CompiledGateRef::Kind::JUNCTION:        return compiledJunctions.outputId(ref.index);
+	case CompiledGateRef::Kind::NONE:            break;
+	}
+	return 0;
+}
+
+logic_state_t LogicSimulator::evaluateCompiledGate(CompiledGateRef ref, const logic_state_t* states) const {
+	const size_t i = ref.index;
+	switch (ref.kind) {
+	case CompiledGateRef::Kind::AND:
+		return ANDLikeGate::calculate(
+			compiledAndGates.rangeBegin(i), compiledAndGates.rangeEnd(i),
+			compiledAndGates.hasFlag(i, CompiledGateList::INPUTS_INVERTED), compiledAndGates.hasFlag(i, CompiledGateList::OUTPUT_INVERTED), states
+		);
+	case CompiledGateRef::Kind::XOR:
+		return XORLikeGate::calculate(compiledXorGates.rangeBegin(i), compiledXorGates.rangeEnd(i), compiledXorGates.hasFlag(i, CompiledGateList::OUTPUT_INVERTED), states);
+	case CompiledGateRef::Kind::TRISTATE_BUFFER:
+		return TristateBufferGate::calculate(
+			compiledTristateBuffers.rangeBegin(i, 0), compiledTristateBuffers.rangeEnd(i, 0),
+			compiledTristateBuffers.rangeBegin(i, 1), compiledTristateBuffers.rangeEnd(i, 1),
+			compiledTristateBuffers.hasFlag(i, CompiledGateList::ENABLE_INVERTED), states
+		);
+	case CompiledGateRef::Kind::JUNCTION:
+		return JunctionGate::calculate(compiledJunctions.rangeBegin(i), compiledJunctions.rangeEnd(i), states);
+	case CompiledGateRef::Kind::NONE:
+		break;
+	}
+	return logic_state_t::UNDEFINED;
+}
+
+void LogicSimulator::levelize() {
+	const size_t idCount = compiledGateRefs.size();
+	auto isGate = [&](simulator_id_t id) { return compiledGateRefs[id].kind != CompiledGateRef::Kind::NONE; };
+	auto forEachFanout = [&](simulator_id_t id, auto&& func) {
+		for (std::uint32_t i = fanoutOffsets[id]; i < fanoutOffsets[id + 1]; ++i) {
+			if (fanoutRefs[i].kind != CompiledGateRef::Kind::NONE) func(getCompiledOutputId(fanoutRefs[i]));
+		}
+	};
+
+	// find the gates that are on a cycle with iterative Tarjan
+	constexpr std::uint32_t unvisited = ~std::uint32_t(0);
+	std::vector<std::uint32_t> index(idCount, unvisited);
+	std::vector<std::uint32_t> lowLink(idCount, 0);
+	std::vector<std::uint8_t> onStack(idCount, 0);
+	std::vector<std::uint8_t> onCycle(idCount, 0);
+	std::vector<simulator_id_t> sccStack;
+	std::vector<std::pair<simulator_id_t, std::uint32_t>> callStack; // id, next fanout slot
+	std::uint32_t nextIndex = 0;
+	for (simulator_id_t root = 0; root < idCount; ++root) {
+		if (!isGate(root) || index[root] != unvisited) continue;
+		callStack.push_back({ root, fanoutOffsets[root] });
+		index[root] = lowLink[root] = nextIndex++;
+		sccStack.push_back(root);
+		onStack[root] = 1;
+		while (!callStack.empty()) {
+			auto& [id, slot] = callStack.back();
+			if (slot < fanoutOffsets[id + 1]) {
+				const CompiledGateRef ref = fanoutRefs[slot++];
+				if (ref.kind == CompiledGateRef::Kind::NONE) continue;
+				const simulator_id_t next = getCompiledOutputId(ref);
+				if (next == id) {
+					onCycle[id] = 1;
+				} else if (index[next] == unvisited) {
+					index[next] = lowLink[next] = nextIndex++;
+					sccStack.push_back(next);
+					onStack[next] = 1;
+					callStack.push_back({ next, fanoutOffsets[next] });
+				} else if (onStack[next]) {
+					lowLink[id] = std::min(lowLink[id], index[next]);
+				}
+				continue;
+			}
+			const simulator_id_t finished = id;
+			callStack.pop_back();
+			if (!callStack.empty()) {
+				lowLink[callStack.back().first] = std::min(lowLink[callStack.back().first], lowLink[finished]);
+			}
+			if (lowLink[finished] != index[finished]) continue;
+			// finished is the root of an scc
+			const bool isCycle = sccStack.back() != finished;
+			simulator_id_t member;
+			do {
+				member = sccStack.back();
+				sccStack.pop_back();
+				onStack[member] = 0;
+				if (isCycle) onCycle[member] = 1;
+			} while (member != finished);
+		}
+	}
+
+	// junctions have no delay, so only the other gates on a cycle can break it
+	feedbackGates.clear();
+	levelizedGates.clear();
+	std::vector<std::uint8_t> isFeedback(idCount, 0);
+	for (simulator_id_t id = 0; id < idCount; ++id) {
+		if (isGate(id) && onCycle[id] && compiledGateRefs[id].kind != CompiledGateRef::Kind::JUNCTION) {
+			isFeedback[id] = 1;
+			feedbackGates.push_back(compiledGateRefs[id]);
+		}
+	}
+
+	// Kahn's algorithm over the remaining gates. feedback gates are computed before the ordered pass,
+	// so edges into or out of them do not constrain the order
+	std::vector<std::uint32_t> inDegree(idCount, 0);
+	for (simulator_id_t id = 0; id < idCount; ++id) {
+		if (!isGate(id) || isFeedback[id]) continue;
+		forEachFanout(id, [&](simulator_id_t next) { if (!isFeedback[next] && next != id) ++inDegree[next]; });
+	}
+	std::vector<simulator_id_t> ready;
+	for (simulator_id_t id = 0; id < idCount; ++id) {
+		if (isGate(id) && !isFeedback[id] && inDegree[id] == 0) ready.push_back(id);
+	}
+	std::vector<std::uint8_t> placed(idCount, 0);
+	for (size_t i = 0; i < ready.size(); ++i) {
+		const simulator_id_t id = ready[i];
+		placed[id] = 1;
+		levelizedGates.push_back(compiledGateRefs[id]);
+		forEachFanout(id, [&](simulator_id_t next) {
+			if (!isFeedback[next] && next != id && --inDegree[next] == 0) ready.push_back(next);
+		});
+	}
+	// whatever is left is a loop made only of junctions, which has no defined order
+	for (simulator_id_t id = 0; id < idCount; ++id) {
+		if (isGate(id) && !isFeedback[id] && !placed[id]) levelizedGates.push_back(compiledGateRefs[id]);
+	}
+
+	levelizationDirty = false;
+	logInfo("{} feedback gates and {} levelized gates", "LogicSimulator::levelize", feedbackGates.size(), levelizedGates.size());
+}
+
+void LogicSimulator::tickLevelized() {
+	const logic_state_t* statesAData = statesA.data();
+	logic_state_t* statesBData = statesB.data();
+	for (CompiledGateRef ref : feedbackGates) {
+		statesBData[getCompiledOutputId(ref)] = evaluateCompiledGate(ref, statesAData);
+	}
+	for (const auto& gate : constantResetGates) {
+		statesBData[gate.getId()] = gate.calculate();
+	}
+	for (const auto& gate : copySelfOutputGates) {
+		statesBData[gate.getId()] = statesAData[gate.getId()];
+	}
+	// buffers always delay, so like feedback gates they read statesA and break any cycle through them
+	for (auto& gate : buffers) {
+		gate.tick(statesA, statesB);
+	}
+	for (CompiledGateRef ref : levelizedGates) {
+		statesBData[getCompiledOutputId(ref)] = evaluateCompiledGate(ref, statesBData);
+	}
+}
+
+// junctions are resolved in order and in place so that chained junctions settle in the same tick
+void LogicSimulator::tickJunctions(std::vector<logic_state_t>& states) {
+	logic_state_t* statesData = states.data();
+	for (size_t i = 0; i < compiledJunctions.size(); ++i) {
+		statesData[compiledJunctions.outputId(i)] = JunctionGate::calculate(compiledJunctions.rangeBegin(i), compiledJunctions.rangeEnd(i), statesData);
+	}
+}
+
+void LogicSimulator::doubleTickJunctions() {
+	// between an edit and endEdit the compiled layout is stale, so fall back to the edit time gates
+	if (compiledDirty) {
+		for (auto& gate : junctions) gate.doubleTick(statesA, statesB);
+		return;
+	}
+	for (size_t i = 0; i < compiledJunctions.size(); ++i) {
+		const simulator_id_t id = compiledJunctions.outputId(i);
+		const logic_state_t state = JunctionGate::calculate(compiledJunctions.rangeBegin(i), compiledJunctions.rangeEnd(i), statesB.data());
+		if (statesA[id] != state) {
+			recordExternalChange(id);
+		}
+		statesA[id] = state;
+		statesB[id] = state;
+	}
+}
+
+void LogicSimulator::recordExternalChange(simulator_id_t id) {
+	if (history.isEnabled()) {
+		externalChangesBefore.push_back({ id, statesA[id] });
+	}
+	if (stateChangeFeeds.hasSubscribers()) {
+		stateChangeFeeds.addChanges(std::span<const simulator_id_t>(&id, 1));
+	}
+	// full evaluation picks up every change on its own
+	if (evaluationMode == EvaluationMode::EVENT_DRIVEN && !needsFullEvaluation) {
+		externalChangedIds.push_back(id);
+	}
+}
+
+void LogicSimulator::collectChangedIds() {
+	changedIds.clear();
+	externalChangedIds.clear();
+	for (simulator_id_t id = 0; id < statesA.size(); ++id) {
+		if (statesA[id] != statesB[id]) {
+			changedIds.push_back(id);
+		}
+	}
+	needsFullEvaluation = false;
+}
+
+void LogicSimulator::scheduleGate(simulator_id_t id, CompiledGateRef ref) {
+	if (scheduledFlags[id]) return;
+	switch (ref.kind) {
+	case CompiledGateRef::Kind::AND:             scheduledAndGates.push_back(ref.index); break;
+	case CompiledGateRef::Kind::XOR:             scheduledXorGates.push_back(ref.index); break;
+	case CompiledGateRef::Kind::TRISTATE_BUFFER: scheduledTristateBuffers.push_back(ref.index); break;
+	case CompiledGateRef::Kind::JUNCTION:        scheduledJunctions.push_back(ref.index); break;
+	case CompiledGateRef::Kind::NONE:            return;
+	}
+	scheduledFlags[id] = 1;
+}
+
+void LogicSimulator::scheduleFanout(simulator_id_t id, bool junctions) {
+	if (id + 1 >= fanoutOffsets.size()) return;
+	for (std::uint32_t i = fanoutOffsets[id]; i < fanoutOffsets[id + 1]; ++i) {
+		const CompiledGateRef ref = fanoutRefs[i];
+		if ((ref.kind == CompiledGateRef::Kind::JUNCTION) != junctions) continue;
+		switch (ref.kind) {
+		case CompiledGateRef::Kind::AND:             scheduleGate(compiledAndGates.outputId(ref.index), ref); break;
+		case CompiledGateRef::Kind::XOR:             scheduleGate(compiledXorGates.outputId(ref.index), ref); break;
+		case CompiledGateRef::Kind::TRISTATE_BUFFER: scheduleGate(compiledTristateBuffers.outputId(ref.index), ref); break;
+		case CompiledGateRef::Kind::JUNCTION:        scheduleGate(compiledJunctions.outputId(ref.index), ref); break;
+		case CompiledGateRef::Kind::NONE:            break;
+		}
+	}
+}
+
+// Same result as a full tick, but only gates that read an id changed in the last tick are evaluated.
+// Gates that are skipped would recompute the value they already hold, so statesB only has to be
+// brought up to date for the ids that changed.
+void LogicSimulator::tickEventDriven() {
+	const logic_state_t* statesAData = statesA.data();
+	logic_state_t* statesBData = statesB.data();
+	const bool isRealistic = evaluatedRealistic;
+
+	for (simulator_id_t id : changedIds) {
+		statesBData[id] = statesAData[id];
+		scheduleFanout(id, false);
+		// realistic gates depend on their own previous state
+		if (isRealistic && id < compiledGateRefs.size() && compiledGateRefs[id].kind != CompiledGateRef::Kind::JUNCTION) {
+			scheduleGate(id, compiledGateRefs[id]);
+		}
+	}
+	// a state forced from outside has to be recomputed by its own gate as well
+	for (simulator_id_t id : externalChangedIds) {
+		if (id >= statesB.size()) continue;
+		statesBData[id] = statesAData[id];
+		scheduleFanout(id, false);
+		if (id < compiledGateRefs.size() && compiledGateRefs[id].kind != CompiledGateRef::Kind::JUNCTION) {
+			scheduleGate(id, compiledGateRefs[id]);
+		}
+	}
+	externalChangedIds.clear();
+	changedIds.clear();
+
+	auto commit = [&](simulator_id_t id, logic_state_t state) {
+		if (isRealistic) state = realisticState(statesAData[id], state);
+		statesBData[id] = state;
+		scheduledFlags[id] = 0;
+		if (state != statesAData[id]) changedIds.push_back(id);
+	};
+
+	for (std::uint32_t i : scheduledAndGates) {
+		commit(compiledAndGates.outputId(i), ANDLikeGate::calculate(
+			compiledAndGates.rangeBegin(i), compiledAndGates.rangeEnd(i),
+			compiledAndGates.hasFlag(i, CompiledGateList::INPUTS_INVERTED), compiledAndGates.hasFlag(i, CompiledGateList::OUTPUT_INVERTED), statesAData
+		));
+	}
+	for (std::uint32_t i : scheduledXorGates) {
+		commit(compiledXorGates.outputId(i), XORLikeGate::calculate(
+			compiledXorGates.rangeBegin(i), compiledXorGates.rangeEnd(i), compiledXorGates.hasFlag(i, CompiledGateList::OUTPUT_INVERTED), statesAData
+		));
+	}
+	for (std::uint32_t i : scheduledTristateBuffers) {
+		commit(compiledTristateBuffers.outputId(i), TristateBufferGate::calculate(
+			compiledTristateBuffers.rangeBegin(i, 0), compiledTristateBuffers.rangeEnd(i, 0),
+			compiledTristateBuffers.rangeBegin(i, 1), compiledTristateBuffers.rangeEnd(i, 1),
+			compiledTristateBuffers.hasFlag(i, CompiledGateList::ENABLE_INVERTED), statesAData
+		));
+	}
+	scheduledAndGates.clear();
+	scheduledXorGates.clear();
+	scheduledTristateBuffers.clear();
+
+	for (const auto& gate : constantResetGates) {
+		const simulator_id_t id = gate.getId();
+		statesBData[id] = gate.calculate();
+		if (statesBData[id] != statesAData[id]) changedIds.push_back(id);
+	}
+	// a delay line can change its output without any input changing, so buffers are ticked every tick
+	for (auto& gate : buffers) {
+		const simulator_id_t id = gate.getId();
+		if (isRealistic) {
+			gate.realisticTick(statesA, statesB);
+		} else {
+			gate.tick(statesA, statesB);
+		}
+		if (statesBData[id] != statesAData[id]) changedIds.push_back(id);
+	}
+
+	// junctions settle within the tick, so they are scheduled by this tick's changes. Merged junctions
+	// never read other junctions, so one in order pass is enough.
+	const size_t gateChangeCount = changedIds.size();
+	for (size_t i = 0; i < gateChangeCount; ++i) {
+		scheduleFanout(changedIds[i], true);
+	}
+	std::sort(scheduledJunctions.begin(), scheduledJunctions.end());
+	for (std::uint32_t i : scheduledJunctions) {
+		const simulator_id_t id = compiledJunctions.outputId(i);
+		statesBData[id] = JunctionGate::calculate(compiledJunctions.rangeBegin(i), compiledJunctions.rangeEnd(i), statesBData);
+		scheduledFlags[id] = 0;
+		if (statesBData[id] != statesAData[id]) changedIds.push_back(id);
+	}
+	scheduledJunctions.clear();
 }
 
 void LogicSimulator::regenerateJobs() {
 	threadPool.waitForCompletion();
+	if (compiledDirty) {
+		compileGates();
+		// the recorded ids and buffer indices belong to the old netlist
+		history.clear();
+		stateChangeFeeds.markAllChanged();
+	}
+	if (history.getDepth() != evalConfig.getHistoryDepth()) {
+		history.setDepth(evalConfig.getHistoryDepth());
+	}
+	if (evaluationMode != evalConfig.getEvaluationMode() || evaluatedRealistic != evalConfig.isRealistic()) {
+		evaluationMode = evalConfig.getEvaluationMode();
+		evaluatedRealistic = evalConfig.isRealistic();
+		needsFullEvaluation = true;
+	}
+	if (evaluationMode == EvaluationMode::LEVELIZED && levelizationDirty) {
+		levelize();
+	}
 	jobs.clear();
 	jobInstructionStorage.clear();
+	std::vector<simulator_id_t> jobFirstIds;
 	bool isRealistic = evalConfig.isRealistic();
 
 	auto makeJI = [&](size_t start, size_t end) -> JobInstruction* {
@@ -688,57 +1412,130 @@ void LogicSimulator::regenerateJobs() {
 
 	constexpr size_t batch = 512;
 
-	for (size_t i = 0; i < andGates.size(); i += batch) {
-		JobInstruction* ji = makeJI(i, std::min(i + batch, andGates.size()));
+	for (size_t i = 0; i < compiledAndGates.size(); i += batch) {
+		JobInstruction* ji = makeJI(i, std::min(i + batch, compiledAndGates.size()));
+		jobFirstIds.push_back(compiledAndGates.outputId(i));
 		jobs.push_back(ThreadPool::Job{ isRealistic ? &LogicSimulator::execANDRealistic : &LogicSimulator::execAND, ji });
 	}
-	for (size_t i = 0; i < xorGates.size(); i += batch) {
-		JobInstruction* ji = makeJI(i, std::min(i + batch, xorGates.size()));
+	for (size_t i = 0; i < compiledXorGates.size(); i += batch) {
+		JobInstruction* ji = makeJI(i, std::min(i + batch, compiledXorGates.size()));
+		jobFirstIds.push_back(compiledXorGates.outputId(i));
 		jobs.push_back(ThreadPool::Job{ isRealistic ? &LogicSimulator::execXORRealistic : &LogicSimulator::execXOR, ji });
 	}
-	for (size_t i = 0; i < tristateBuffers.size(); i += batch) {
-		JobInstruction* ji = makeJI(i, std::min(i + batch, tristateBuffers.size()));
+	for (size_t i = 0; i < compiledTristateBuffers.size(); i += batch) {
+		JobInstruction* ji = makeJI(i, std::min(i + batch, compiledTristateBuffers.size()));
+		jobFirstIds.push_back(compiledTristateBuffers.outputId(i));
 		jobs.push_back(ThreadPool::Job{ isRealistic ? &LogicSimulator::execTristateRealistic : &LogicSimulator::execTristate, ji });
 	}
 	for (size_t i = 0; i < constantResetGates.size(); i += batch) {
 		JobInstruction* ji = makeJI(i, std::min(i + batch, constantResetGates.size()));
+		jobFirstIds.push_back(constantResetGates[i].getId());
 		jobs.push_back(ThreadPool::Job{ &LogicSimulator::execConstantReset, ji });
 	}
 	for (size_t i = 0; i < copySelfOutputGates.size(); i += batch) {
 		JobInstruction* ji = makeJI(i, std::min(i + batch, copySelfOutputGates.size()));
+		jobFirstIds.push_back(copySelfOutputGates[i].getId());
 		jobs.push_back(ThreadPool::Job{ &LogicSimulator::execCopySelfOutput, ji });
 	}
-	if (jobs.size() < std::thread::hardware_concurrency() / 2) {
-		threadPool.resizeThreads(jobs.size());
-	} else {
-		threadPool.resizeThreads(std::thread::hardware_concurrency() / 2);
+	for (size_t i = 0; i < buffers.size(); i += batch) {
+		JobInstruction* ji = makeJI(i, std::min(i + batch, buffers.size()));
+		jobFirstIds.push_back(buffers[i].getId());
+		jobs.push_back(ThreadPool::Job{ isRealistic ? &LogicSimulator::execBufferRealistic : &LogicSimulator::execBuffer, ji });
+	}
+	// order the jobs by the ids they write so each worker's share of the jobs is a contiguous slice of
+	// the state vectors
+	std::vector<std::pair<simulator_id_t, size_t>> jobOrder;
+	jobOrder.reserve(jobs.size());
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		jobOrder.push_back({ jobFirstIds[i], i });
 	}
+	std::stable_sort(jobOrder.begin(), jobOrder.end());
+	std::vector<ThreadPool::Job> orderedJobs;
+	orderedJobs.reserve(jobs.size());
+	for (const auto& [firstId, index] : jobOrder) {
+		orderedJobs.push_back(jobs[index]);
+	}
+	jobs = std::move(orderedJobs);
+
+	size_t threadCount = evalConfig.getThreadCount();
+	if (threadCount == 0) {
+		threadCount = std::thread::hardware_concurrency() / 2;
+	}
+	threadPool.setPinThreads(evalConfig.isThreadPinningEnabled());
+	threadPool.resizeThreads(std::min(threadCount, jobs.size()));
 	logInfo("{} jobs created for the current round", "LogicSimulator::regenerateJobs", jobs.size());
 }
 
 void LogicSimulator::execAND(void* jobInstruction) {
 	auto* ji = static_cast<JobInstruction*>(jobInstruction);
-	for (size_t i = ji->start; i < ji->end; ++i) ji->self->andGates[i].tick(ji->self->statesA, ji->self->statesB);
+	const CompiledGateList& gates = ji->self->compiledAndGates;
+	const logic_state_t* statesA = ji->self->statesA.data();
+	logic_state_t* statesB = ji->self->statesB.data();
+	for (size_t i = ji->start; i < ji->end; ++i) {
+		statesB[gates.outputId(i)] = ANDLikeGate::calculate(
+			gates.rangeBegin(i), gates.rangeEnd(i),
+			gates.hasFlag(i, CompiledGateList::INPUTS_INVERTED), gates.hasFlag(i, CompiledGateList::OUTPUT_INVERTED), statesA
+		);
+	}
 }
 void LogicSimulator::execANDRealistic(void* jobInstruction) {
 	auto* ji = static_cast<JobInstruction*>(jobInstruction);
-	for (size_t i = ji->start; i < ji->end; ++i) ji->self->andGates[i].realisticTick(ji->self->statesA, ji->self->statesB);
+	const CompiledGateList& gates = ji->self->compiledAndGates;
+	const logic_state_t* statesA = ji->self->statesA.data();
+	logic_state_t* statesB = ji->self->statesB.data();
+	for (size_t i = ji->start; i < ji->end; ++i) {
+		const simulator_id_t id = gates.outputId(i);
+		statesB[id] = realisticState(statesA[id], ANDLikeGate::calculate(
+			gates.rangeBegin(i), gates.rangeEnd(i),
+			gates.hasFlag(i, CompiledGateList::INPUTS_INVERTED), gates.hasFlag(i, CompiledGateList::OUTPUT_INVERTED), statesA
+		));
+	}
 }
 void LogicSimulator::execXOR(void* jobInstruction) {
 	auto* ji = static_cast<JobInstruction*>(jobInstruction);
-	for (size_t i = ji->start; i < ji->end; ++i) ji->self->xorGates[i].tick(ji->self->statesA, ji->self->statesB);
+	const CompiledGateList& gates = ji->self->compiledXorGates;
+	const logic_state_t* statesA = ji->self->statesA.data();
+	logic_state_t* statesB = ji->self->statesB.data();
+	for (size_t i = ji->start; i < ji->end; ++i) {
+		statesB[gates.outputId(i)] = XORLikeGate::calculate(gates.rangeBegin(i), gates.rangeEnd(i), gates.hasFlag(i, CompiledGateList::OUTPUT_INVERTED), statesA);
+	}
 }
 void LogicSimulator::execXORRealistic(void* jobInstruction) {
 	auto* ji = static_cast<JobInstruction*>(jobInstruction);
-	for (size_t i = ji->start; i < ji->end; ++i) ji->self->xorGates[i].realisticTick(ji->self->statesA, ji->self->statesB);
+	const CompiledGateList& gates = ji->self->compiledXorGates;
+	const logic_state_t* statesA = ji->self->statesA.data();
+	logic_state_t* statesB = ji->self->statesB.data();
+	for (size_t i = ji->start; i < ji->end; ++i) {
+		const simulator_id_t id = gates.outputId(i);
+		statesB[id] = realisticState(statesA[id], XORLikeGate::calculate(gates.rangeBegin(i), gates.rangeEnd(i), gates.hasFlag(i, CompiledGateList::OUTPUT_INVERTED), statesA));
+	}
 }
 void LogicSimulator::execTristate(void* jobInstruction) {
 	auto* ji = static_cast<JobInstruction*>(jobInstruction);
-	for (size_t i = ji->start; i < ji->end; ++i) ji->self->tristateBuffers[i].tick(ji->self->statesA, ji->self->statesB);
+	const CompiledGateList& gates = ji->self->compiledTristateBuffers;
+	const logic_state_t* statesA = ji->self->statesA.data();
+	logic_state_t* statesB = ji->self->statesB.data();
+	for (size_t i = ji->start; i < ji->end; ++i) {
+		statesB[gates.outputId(i)] = TristateBufferGate::calculate(
+			gates.rangeBegin(i, 0), gates.rangeEnd(i, 0),
+			gates.rangeBegin(i, 1), gates.rangeEnd(i, 1),
+			gates.hasFlag(i, CompiledGateList::ENABLE_INVERTED), statesA
+		);
+	}
 }
 void LogicSimulator::execTristateRealistic(void* jobInstruction) {
 	auto* ji = static_cast<JobInstruction*>(jobInstruction);
-	for (size_t i = ji->start; i < ji->end; ++i) ji->self->tristateBuffers[i].realisticTick(ji->self->statesA, ji->self->statesB);
+	const CompiledGateList& gates = ji->self->compiledTristateBuffers;
+	const logic_state_t* statesA = ji->self->statesA.data();
+	logic_state_t* statesB = ji->self->statesB.data();
+	for (size_t i = ji->start; i < ji->end; ++i) {
+		const simulator_id_t id = gates.outputId(i);
+		statesB[id] = realisticState(statesA[id], TristateBufferGate::calculate(
+			gates.rangeBegin(i, 0), gates.rangeEnd(i, 0),
+			gates.rangeBegin(i, 1), gates.rangeEnd(i, 1),
+			gates.hasFlag(i, CompiledGateList::ENABLE_INVERTED), statesA
+		));
+	}
 }
 void LogicSimulator::execConstantReset(void* jobInstruction) {
 	auto* ji = static_cast<JobInstruction*>(jobInstruction);
@@ -747,4 +1544,12 @@ void LogicSimulator::execConstantReset(void* jobInstruction) {
 void LogicSimulator::execCopySelfOutput(void* jobInstruction) {
 	auto* ji = static_cast<JobInstruction*>(jobInstruction);
 	for (size_t i = ji->start; i < ji->end; ++i) ji->self->copySelfOutputGates[i].tick(ji->self->statesA, ji->self->statesB);
-}
\ No newline at end of file
+}
+void LogicSimulator::execBuffer(void* jobInstruction) {
+	auto* ji = static_cast<JobInstruction*>(jobInstruction);
+	for (size_t i = ji->start; i < ji->end; ++i) ji->self->buffers[i].tick(ji->self->statesA, ji->self->statesB);
+}
+void LogicSimulator::execBufferRealistic(void* jobInstruction) {
+	auto* ji = static_cast<JobInstruction*>(jobInstruction);
+	for (size_t i = ji->start; i < ji->end; ++i) ji->self->buffers[i].realisticTick(ji->self->statesA, ji->self->statesB);
+}
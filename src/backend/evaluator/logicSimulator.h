@@ -2,6 +2,11 @@
 #define logicSimulator_h
 
 #include "simulatorGates.h"
+#include "simulatorSnapshot.h"
+#include "stateHistory.h"
+#include "waveformRecorder.h"
+#include "stateChangeFeeds.h"
+#include "compiledGates.h"
 #include "gateType.h"
 #include "idProvider.h"
 #include "evalConnection.h"
@@ -23,12 +28,33 @@ enum class SimGateType : int {
 class LogicSimulator {
 friend class SimulatorOptimizer;
 friend class SimPauseGuard;
+friend class BatchedSimulator;
 public:
 	LogicSimulator(
 		EvalConfig& evalConfig,
 		std::vector<simulator_id_t>& dirtySimulatorIds);
 	~LogicSimulator();
+	// puts every gate back into the state it had when it was added
 	void clearState();
+	// takeSnapshot and restoreSnapshot must be called with the simulator paused
+	SimulatorSnapshot takeSnapshot() const;
+	bool restoreSnapshot(const SimulatorSnapshot& snapshot);
+	// identifies the gates, their ids and their connections, but not their states
+	std::uint64_t getNetlistHash() const;
+	// Undo or redo up to nTicks recorded steps (see EvalConfig::getHistoryDepth) and return how many were
+	// stepped. Must be called with the simulator paused. States set from outside between ticks, together with
+	// the junctions they settle, are recorded as a step of their own.
+	unsigned int stepBack(unsigned int nTicks);
+	unsigned int stepForward(unsigned int nTicks);
+	// Samples recorder after every tick until replaced, nullptr detaches it. Must be called with the simulator
+	// paused. Renumbering the ids is followed, edits that move a block to another id are not.
+	void setWaveformRecorder(std::shared_ptr<WaveformRecorder> recorder);
+	// see StateChangeFeeds, safe to use while the simulation runs
+	state_change_feed_id_t subscribeStateChanges() { return stateChangeFeeds.subscribe(); }
+	void unsubscribeStateChanges(state_change_feed_id_t feed) { stateChangeFeeds.unsubscribe(feed); }
+	std::vector<simulator_id_t> takeChangedIds(state_change_feed_id_t feed) {
+		return stateChangeFeeds.takeChanges(feed, publishedStateCount.load(std::memory_order_relaxed));
+	}
 	double getAverageTickrate() const;
 	void setState(simulator_id_t id, logic_state_t state);
 
@@ -37,11 +63,22 @@ public:
 	std::optional<simulator_id_t> getOutputPortId(simulator_id_t simId, connection_port_id_t portId) const;
 
 	simulator_id_t addGate(const GateType gateType);
+	// a buffer whose output follows its input delayTicks ticks later (at least 1)
+	simulator_id_t addDelayGate(unsigned int delayTicks, bool outputInverted = false);
 	void removeGate(simulator_id_t gateId);
 	void makeConnection(simulator_id_t sourceId, connection_port_id_t sourcePort, simulator_id_t destinationId, connection_port_id_t destinationPort);
 	void removeConnection(simulator_id_t sourceId, connection_port_id_t sourcePort, simulator_id_t destinationId, connection_port_id_t destinationPort);
 	void endEdit();
 
+	// Renumbers the live gates. Returns oldToNew, where oldToNew[id] is the new id of id (0 if unused).
+	// Must be called inside an edit; the callers have to remap their own copies of simulator ids.
+	std::vector<simulator_id_t> renumberForLocality();
+	// Renumbers the live gates densely in evaluation order and shrinks the state vectors. Same contract
+	// as renumberForLocality.
+	std::vector<simulator_id_t> compactIds();
+	// true once most of the id range is made of freed ids
+	bool isFragmented() const;
+
 private:
 	EvalConfig& evalConfig;
 	std::thread simulationThread;
@@ -49,6 +86,7 @@ private:
 
 	std::atomic<bool> pauseRequest { false };
 	std::atomic<bool> isPaused { false };
+	unsigned int pauseGuardCount = 0; // guarded by cvMutex, the last guard to go away resumes the sim
 	std::mutex cvMutex;
 	std::condition_variable cv;
 
@@ -58,6 +96,32 @@ private:
 	mutable std::shared_mutex statesAMutex;
 	std::mutex statesBMutex;
 
+	// Seqlock over statesA for getState/getStates, so readers never hold up the swap at the end of a
+	// tick. statesSequence is odd while statesA is written or swapped; a reader that sees it change
+	// retries and after a few tries falls back to statesAMutex. Writers that reallocate the state
+	// vectors first wait for activeReaders to drain, so no reader is left on a freed buffer.
+	static constexpr unsigned int optimisticReadAttempts = 4;
+	std::atomic<std::uint64_t> statesSequence { 0 };
+	std::atomic<const logic_state_t*> publishedStates { nullptr };
+	std::atomic<size_t> publishedStateCount { 0 };
+	mutable std::atomic<std::uint32_t> activeReaders { 0 };
+
+	void beginStatesWrite() {
+		statesSequence.fetch_add(1, std::memory_order_seq_cst);
+	}
+	void endStatesWrite() {
+		publishedStates.store(statesA.data(), std::memory_order_relaxed);
+		publishedStateCount.store(statesA.size(), std::memory_order_relaxed);
+		statesSequence.fetch_add(1, std::memory_order_release);
+	}
+	void waitForStateReaders() const {
+		while (activeReaders.load(std::memory_order_seq_cst) != 0) {
+			std::this_thread::yield();
+		}
+	}
+	template <typename Read>
+	void readStates(Read&& read) const;
+
 	struct StateChange {
 		simulator_id_t id;
 		logic_state_t state;
@@ -75,6 +139,64 @@ private:
 	std::vector<ConstantResetGate> constantResetGates;
 	std::vector<CopySelfOutputGate> copySelfOutputGates;
 
+	// tick time layout of the gates above, rebuilt by compileGates() (see compiledGates.h)
+	CompiledGateList compiledAndGates;
+	CompiledGateList compiledXorGates;
+	CompiledGateList compiledJunctions;
+	CompiledGateList compiledTristateBuffers;
+	bool compiledDirty = true;
+
+	void compileGateLists(CompiledGateList& andList, CompiledGateList& xorList, CompiledGateList& junctionList, CompiledGateList& tristateList) const;
+	void compileGates();
+	void tickJunctions(std::vector<logic_state_t>& states);
+	void doubleTickJunctions();
+
+	// event driven evaluation (EvaluationMode::EVENT_DRIVEN). changedIds holds every id whose state in
+	// statesA differs from statesB, everywhere else the two buffers agree.
+	EvaluationMode evaluationMode = EvaluationMode::FULL;
+	bool evaluatedRealistic = false;
+	bool needsFullEvaluation = true;
+	std::vector<CompiledGateRef> compiledGateRefs; // indexed by simulator id
+	std::vector<std::uint32_t> fanoutOffsets; // indexed by simulator id, into fanoutRefs
+	std::vector<CompiledGateRef> fanoutRefs;
+	std::vector<simulator_id_t> changedIds;
+	std::vector<simulator_id_t> externalChangedIds; // set by setState and junction propagation outside of a tick
+	std::vector<std::uint8_t> scheduledFlags; // indexed by simulator id
+	std::vector<std::uint32_t> scheduledAndGates;
+	std::vector<std::uint32_t> scheduledXorGates;
+	std::vector<std::uint32_t> scheduledTristateBuffers;
+	std::vector<std::uint32_t> scheduledJunctions;
+
+	// levelized evaluation (EvaluationMode::LEVELIZED). feedbackGates are gates on a cycle, evaluated
+	// from statesA with unit delay; levelizedGates are everything else in topological order, evaluated
+	// from statesB so each acyclic cone settles in a single pass.
+	bool levelizationDirty = true;
+	std::vector<CompiledGateRef> feedbackGates;
+	std::vector<CompiledGateRef> levelizedGates;
+
+	// recorded by tickOnce while the history is enabled, cleared whenever the netlist or the ids change
+	StateHistory history;
+	std::vector<logic_state_t> delaySlotsBefore; // per buffer, the delay line slot the coming tick overwrites
+	void recordHistory(const std::vector<simulator_id_t>& tickChanges);
+	std::vector<StateChange> externalChangesBefore; // the states ids had before the external changes being applied
+	void recordExternalHistory();
+	StateChangeFeeds stateChangeFeeds;
+	std::vector<simulator_id_t> tickChangedIds; // scratch for collectTickChanges
+	const std::vector<simulator_id_t>& collectTickChanges();
+	std::shared_ptr<WaveformRecorder> waveformRecorder;
+
+	void levelize();
+	void tickLevelized();
+	simulator_id_t getCompiledOutputId(CompiledGateRef ref) const;
+	logic_state_t evaluateCompiledGate(CompiledGateRef ref, const logic_state_t* states) const;
+
+	void tickEventDriven();
+	void collectChangedIds();
+	// must be called before the state of id is overwritten
+	void recordExternalChange(simulator_id_t id);
+	void scheduleGate(simulator_id_t id, CompiledGateRef ref);
+	void scheduleFanout(simulator_id_t id, bool junctions);
+
 	struct JobInstruction {
 		LogicSimulator* self;
 		size_t start;
@@ -90,56 +212,8 @@ private:
 	static void execTristateRealistic(void* jobInstruction);
 	static void execConstantReset(void* jobInstruction);
 	static void execCopySelfOutput(void* jobInstruction);
-
-	void tickANDGates(void* jobInstruction) {
-		auto* ji = static_cast<JobInstruction*>(jobInstruction);
-		for (size_t i = ji->start; i < ji->end; ++i) {
-			andGates[i].tick(statesA, statesB);
-		}
-	};
-	void tickXORGates(void* jobInstruction) {
-		auto* ji = static_cast<JobInstruction*>(jobInstruction);
-		for (size_t i = ji->start; i < ji->end; ++i) {
-			xorGates[i].tick(statesA, statesB);
-		}
-	};
-	void tickTristateBuffers(void* jobInstruction) {
-		auto* ji = static_cast<JobInstruction*>(jobInstruction);
-		for (size_t i = ji->start; i < ji->end; ++i) {
-			tristateBuffers[i].tick(statesA, statesB);
-		}
-	};
-	void tickConstantResetGates(void* jobInstruction) {
-		auto* ji = static_cast<JobInstruction*>(jobInstruction);
-		for (size_t i = ji->start; i < ji->end; ++i) {
-			constantResetGates[i].tick(statesB);
-		}
-	}
-	void tickCopySelfOutputGates(void* jobInstruction) {
-		auto* ji = static_cast<JobInstruction*>(jobInstruction);
-		for (size_t i = ji->start; i < ji->end; ++i) {
-			copySelfOutputGates[i].tick(statesA, statesB);
-		}
-	}
-
-	void realisticTickANDGates(void* jobInstruction) {
-		auto* ji = static_cast<JobInstruction*>(jobInstruction);
-		for (size_t i = ji->start; i < ji->end; ++i) {
-			andGates[i].realisticTick(statesA, statesB);
-		}
-	};
-	void realisticTickXORGates(void* jobInstruction) {
-		auto* ji = static_cast<JobInstruction*>(jobInstruction);
-		for (size_t i = ji->start; i < ji->end; ++i) {
-			xorGates[i].realisticTick(statesA, statesB);
-		}
-	};
-	void realisticTickTristateBuffers(void* jobInstruction) {
-		auto* ji = static_cast<JobInstruction*>(jobInstruction);
-		for (size_t i = ji->start; i < ji->end; ++i) {
-			tristateBuffers[i].realisticTick(statesA, statesB);
-		}
-	};
+	static void execBuffer(void* jobInstruction);
+	static void execBufferRealistic(void* jobInstruction);
 
 	IdProvider<simulator_id_t> simulatorIdProvider;
 
@@ -155,15 +229,54 @@ private:
 	};
 
 	struct GateLocation {
+		static constexpr size_t noGate = std::numeric_limits<size_t>::max();
+
 		SimGateType gateType;
 		size_t gateIndex;
 
-		GateLocation() : gateType(SimGateType::AND), gateIndex(0) {}
+		GateLocation() : gateType(SimGateType::AND), gateIndex(noGate) {}
 		GateLocation(SimGateType type, size_t index) : gateType(type), gateIndex(index) {}
+
+		bool isGate() const { return gateIndex != noGate; }
 	};
 
-	std::unordered_map<simulator_id_t, std::vector<GateDependency>> outputDependencies;
-	std::unordered_map<simulator_id_t, GateLocation> gateLocations;
+	// both indexed by simulator id. ids are handed out densely, so these are plain arrays instead of maps
+	std::vector<std::vector<GateDependency>> outputDependencies; // the gates reading each output id
+	std::vector<GateLocation> gateLocations; // where each gate sits in the gate vectors
+	size_t gateCount = 0;
+
+	const GateLocation* findGateLocation(simulator_id_t gateId) const {
+		if (gateId >= gateLocations.size() || !gateLocations[gateId].isGate()) return nullptr;
+		return &gateLocations[gateId];
+	}
+
+	// Calls fn with the record of gateId from the vector its SimGateType names. Returns false if there is no such gate.
+	template <typename Fn>
+	bool visitGate(simulator_id_t gateId, Fn&& fn) { return visitGate(*this, gateId, fn); }
+	template <typename Fn>
+	bool visitGate(simulator_id_t gateId, Fn&& fn) const { return visitGate(*this, gateId, fn); }
+	template <typename Self, typename Fn>
+	static bool visitGate(Self& self, simulator_id_t gateId, Fn& fn) {
+		const GateLocation* location = self.findGateLocation(gateId);
+		if (!location) return false;
+		auto visitIn = [&](auto& gates) {
+			if (location->gateIndex >= gates.size()) return false;
+			fn(gates[location->gateIndex]);
+			return true;
+		};
+		switch (location->gateType) {
+		case SimGateType::AND:              return visitIn(self.andGates);
+		case SimGateType::XOR:              return visitIn(self.xorGates);
+		case SimGateType::JUNCTION:         return visitIn(self.junctions);
+		case SimGateType::BUFFER:           return visitIn(self.buffers);
+		case SimGateType::SINGLE_BUFFER:    return visitIn(self.singleBuffers);
+		case SimGateType::TRISTATE_BUFFER:  return visitIn(self.tristateBuffers);
+		case SimGateType::CONSTANT:         return visitIn(self.constantGates);
+		case SimGateType::CONSTANT_RESET:   return visitIn(self.constantResetGates);
+		case SimGateType::COPY_SELF_OUTPUT: return visitIn(self.copySelfOutputGates);
+		}
+		return false;
+	}
 
 	void simulationLoop();
 	inline void tickOnce();
@@ -176,7 +289,6 @@ private:
 
 	void addInputToGate(simulator_id_t simId, simulator_id_t inputId, connection_port_id_t portId);
 	void removeInputFromGate(simulator_id_t simId, simulator_id_t inputId, connection_port_id_t portId);
-	std::optional<std::vector<simulator_id_t>> getOutputSimIdsFromGate(simulator_id_t simId) const;
 
 	void updateGateLocation(simulator_id_t gateId, SimGateType gateType, size_t gateIndex);
 	void removeGateLocation(simulator_id_t gateId);
@@ -194,10 +306,22 @@ private:
 
 	void regenerateJobs();
 
+	static constexpr simulator_id_t compactionMinIds = 1024;
+
+	std::vector<simulator_id_t> getLocalityOrder() const;
+	std::vector<simulator_id_t> getEvaluationOrder() const;
+	void remapSimulatorIds(const std::vector<simulator_id_t>& oldToNew);
+
+	// must not be called between beginStatesWrite and endStatesWrite
 	void extendDataVectors(simulator_id_t id) {
 		if (statesA.size() <= id) {
+			beginStatesWrite();
+			if (statesA.capacity() <= id || statesB.capacity() <= id) {
+				waitForStateReaders();
+			}
 			statesA.resize(id + 1, logic_state_t::UNDEFINED);
 			statesB.resize(id + 1, logic_state_t::UNDEFINED);
+			endStatesWrite();
 		}
 	}
 };
@@ -207,18 +331,24 @@ public:
 	explicit SimPauseGuard(LogicSimulator& s) : sim(s) {
 		{
 			std::lock_guard<std::mutex> lk(sim.cvMutex);
-			sim.pauseRequest.store(true, std::memory_order_release);
-			sim.cv.notify_all();
+			if (sim.pauseGuardCount++ == 0) {
+				sim.pauseRequest.store(true, std::memory_order_release);
+				sim.cv.notify_all();
+			}
 		}
 		// wait until the sim thread *confirms* it is paused
 		std::unique_lock<std::mutex> lk(sim.cvMutex);
 		sim.cv.wait(lk, [&]{ return sim.isPaused.load(std::memory_order_acquire); });
 	}
+	SimPauseGuard(const SimPauseGuard&) = delete;
+	SimPauseGuard& operator=(const SimPauseGuard&) = delete;
 	~SimPauseGuard() {
 		{
 			std::lock_guard<std::mutex> lk(sim.cvMutex);
-			sim.pauseRequest.store(false, std::memory_order_release);
-			sim.cv.notify_all();
+			if (--sim.pauseGuardCount == 0) {
+				sim.pauseRequest.store(false, std::memory_order_release);
+				sim.cv.notify_all();
+			}
 		}
 	}
 
@@ -28,4 +28,28 @@ inline logic_state_t fromBool(bool value) {
 	return value ? logic_state_t::HIGH : logic_state_t::LOW;
 }
 
+// logic_state_t is laid out as two bit-planes: bit 0 is the driven value and bit 1 is set when the
+// net is not a valid 0/1 (FLOATING or UNDEFINED). The gate kernels fold their inputs into a 4 bit
+// "seen" mask (one bit per state) so that a gate is evaluated without a branch per input.
+constexpr unsigned int SEEN_LOW = 1u << static_cast<unsigned int>(logic_state_t::LOW);
+constexpr unsigned int SEEN_HIGH = 1u << static_cast<unsigned int>(logic_state_t::HIGH);
+constexpr unsigned int SEEN_FLOATING = 1u << static_cast<unsigned int>(logic_state_t::FLOATING);
+constexpr unsigned int SEEN_UNDEFINED = 1u << static_cast<unsigned int>(logic_state_t::UNDEFINED);
+constexpr unsigned int SEEN_INVALID = SEEN_FLOATING | SEEN_UNDEFINED;
+
+inline constexpr unsigned int seenBit(logic_state_t state) {
+	return 1u << static_cast<unsigned int>(state);
+}
+
+// Resolves a set of drivers sharing one net: FLOATING drivers are ignored, and any UNDEFINED or
+// conflicting drivers make the net UNDEFINED.
+inline constexpr logic_state_t resolveSeenDrivers(unsigned int seen) {
+	if ((seen & SEEN_UNDEFINED) || (seen & (SEEN_LOW | SEEN_HIGH)) == (SEEN_LOW | SEEN_HIGH)) {
+		return logic_state_t::UNDEFINED;
+	}
+	if (seen & SEEN_HIGH) return logic_state_t::HIGH;
+	if (seen & SEEN_LOW) return logic_state_t::LOW;
+	return logic_state_t::FLOATING;
+}
+
 #endif /* logicState_h */
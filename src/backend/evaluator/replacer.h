@@ -14,6 +14,12 @@ struct ReplacementGate {
 	GateType type;
 };
 
+struct RetypedGate {
+	middle_id_t id;
+	GateType oldType;
+	GateType newType;
+};
+
 class Replacement {
 public:
 	Replacement(
@@ -67,6 +73,25 @@ public:
 		simulatorOptimizer->removeGate(pauseGuard, gateId);
 	}
 
+	// gives a gate a type without inputs, keeping its id and output connections so nothing reading it has to be remapped
+	void retypeGate(SimPauseGuard& pauseGuard, middle_id_t gateId, GateType newType) {
+		isEmpty = false;
+		std::vector<EvalConnection> outputs = simulatorOptimizer->getOutputs(gateId);
+		for (const auto& conn : simulatorOptimizer->getInputs(gateId)) {
+			deletedConnections.push_back(conn);
+			idsToTrackOutputs.insert(conn.source.gateId);
+		}
+		idsToTrackInputs.insert(gateId);
+		retypedGates.push_back({ gateId, simulatorOptimizer->getGateType(gateId), newType });
+		simulatorOptimizer->removeGate(pauseGuard, gateId);
+		simulatorOptimizer->addGate(pauseGuard, newType, gateId);
+		for (const auto& conn : outputs) {
+			if (conn.destination.gateId != gateId) {
+				simulatorOptimizer->makeConnection(pauseGuard, conn);
+			}
+		}
+	}
+
 	void addGate(SimPauseGuard& pauseGuard, GateType gateType, middle_id_t gateId) {
 		isEmpty = false;
 		simulatorOptimizer->addGate(pauseGuard, gateType, gateId);
@@ -103,6 +128,15 @@ public:
 			replacedConnectionPoints->erase(gate.id);
 			replacedIds->erase(gate.id);
 		}
+		// the outputs a retyped gate has now are kept, other replacements may have made some of them
+		for (const auto& gate : retypedGates) {
+			std::vector<EvalConnection> outputs = simulatorOptimizer->getOutputs(gate.id);
+			simulatorOptimizer->removeGate(pauseGuard, gate.id);
+			simulatorOptimizer->addGate(pauseGuard, gate.oldType, gate.id);
+			for (const auto& conn : outputs) {
+				simulatorOptimizer->makeConnection(pauseGuard, conn);
+			}
+		}
 		for (const auto& conn : deletedConnections) {
 			simulatorOptimizer->makeConnection(pauseGuard, conn);
 		}
@@ -113,21 +147,59 @@ public:
 		addedGates.clear();
 		deletedConnections.clear();
 		deletedGates.clear();
+		retypedGates.clear();
 		reservedIds.clear();
 		idsToTrackInputs.clear();
 		idsToTrackOutputs.clear();
 	}
 
-	void pingOutput(SimPauseGuard& pauseGuard, middle_id_t id) {
-		if (idsToTrackOutputs.contains(id)) {
-			revert(pauseGuard);
+	// every gate this replacement changed, these need to be looked at again once it is reverted
+	void appendTouchedIds(std::vector<middle_id_t>& touchedIds) const {
+		for (const auto& gate : deletedGates) {
+			touchedIds.push_back(gate.id);
+		}
+		for (const auto& gate : retypedGates) {
+			touchedIds.push_back(gate.id);
+		}
+		for (const auto& conn : addedConnections) {
+			touchedIds.push_back(conn.source.gateId);
+			touchedIds.push_back(conn.destination.gateId);
+		}
+		for (const auto& conn : deletedConnections) {
+			touchedIds.push_back(conn.source.gateId);
+			touchedIds.push_back(conn.destination.gateId);
 		}
 	}
 
-	void pingInput(SimPauseGuard& pauseGuard, middle_id_t id) {
-		if (idsToTrackInputs.contains(id)) {
-			revert(pauseGuard);
+	std::vector<middle_id_t> getRetypedIds() const {
+		std::vector<middle_id_t> ids;
+		ids.reserve(retypedGates.size());
+		for (const auto& gate : retypedGates) {
+			ids.push_back(gate.id);
+		}
+		return ids;
+	}
+	std::vector<middle_id_t> getRemovedIds() const {
+		std::vector<middle_id_t> ids;
+		ids.reserve(deletedGates.size());
+		for (const auto& gate : deletedGates) {
+			ids.push_back(gate.id);
 		}
+		return ids;
+	}
+	// both ends of every connection this replacement made or deleted
+	std::vector<middle_id_t> getConnectedIds() const {
+		std::vector<middle_id_t> ids;
+		ids.reserve((addedConnections.size() + deletedConnections.size()) * 2);
+		for (const auto& conn : addedConnections) {
+			ids.push_back(conn.source.gateId);
+			ids.push_back(conn.destination.gateId);
+		}
+		for (const auto& conn : deletedConnections) {
+			ids.push_back(conn.source.gateId);
+			ids.push_back(conn.destination.gateId);
+		}
+		return ids;
 	}
 
 	bool getIsEmpty() const {
@@ -146,6 +218,12 @@ public:
 	void trackInput(middle_id_t id) {
 		idsToTrackInputs.insert(id);
 	}
+	const std::set<middle_id_t>& getIdsToTrackOutputs() const {
+		return idsToTrackOutputs;
+	}
+	const std::set<middle_id_t>& getIdsToTrackInputs() const {
+		return idsToTrackInputs;
+	}
 
 private:
 	SimulatorOptimizer* simulatorOptimizer;
@@ -154,6 +232,7 @@ private:
 	std::unordered_map<middle_id_t, std::unordered_map<connection_port_id_t, EvalConnectionPoint>>* replacedConnectionPoints;
 	std::vector<ReplacementGate> addedGates;
 	std::vector<ReplacementGate> deletedGates;
+	std::vector<RetypedGate> retypedGates;
 	std::vector<EvalConnection> addedConnections;
 	std::vector<EvalConnection> deletedConnections;
 	std::vector<middle_id_t> reservedIds;
@@ -174,11 +253,22 @@ public:
 
 	inline void addGate(SimPauseGuard& pauseGuard, const GateType gateType, const middle_id_t gateId) {
 		simulatorOptimizer.addGate(pauseGuard, gateType, gateId);
+		touchedIds.push_back(gateId);
+	}
+	inline void addDelayGate(SimPauseGuard& pauseGuard, unsigned int delayTicks, const middle_id_t gateId) {
+		simulatorOptimizer.addDelayGate(pauseGuard, delayTicks, gateId);
+		touchedIds.push_back(gateId);
 	}
 
 	void removeGate(SimPauseGuard& pauseGuard, const middle_id_t gateId) {
 		pingOutputs(pauseGuard, gateId);
 		pingInputs(pauseGuard, gateId);
+		for (const auto& conn : simulatorOptimizer.getOutputs(gateId)) {
+			touchedIds.push_back(conn.destination.gateId);
+		}
+		for (const auto& conn : simulatorOptimizer.getInputs(gateId)) {
+			touchedIds.push_back(conn.source.gateId);
+		}
 		simulatorOptimizer.removeGate(pauseGuard, gateId);
 	}
 
@@ -187,18 +277,61 @@ public:
 	}
 
 	void endEdit(SimPauseGuard& pauseGuard) {
-		cleanReplacements();
-		mergeJunctions(pauseGuard);
+		std::vector<middle_id_t> foldCandidates = touchedIds;
+		mergeJunctions(pauseGuard, foldCandidates);
+		// a folded gate can leave the gates behind the junctions it drives with only constant inputs, so merge and fold
+		// until nothing more folds
+		std::vector<middle_id_t> duplicateCandidates = foldCandidates;
+		while (evalConfig.isConstantFoldingEnabled() && foldConstants(pauseGuard, foldCandidates)) {
+			foldCandidates = touchedIds;
+			mergeJunctions(pauseGuard, foldCandidates);
+			duplicateCandidates.insert(duplicateCandidates.end(), foldCandidates.begin(), foldCandidates.end());
+		}
+		if (evalConfig.isGateMergingEnabled()) {
+			mergeDuplicateGates(pauseGuard, duplicateCandidates);
+		}
 
 		simulatorOptimizer.endEdit(pauseGuard);
 	}
 
+	inline void renumberForLocality(SimPauseGuard& pauseGuard) {
+		simulatorOptimizer.renumberForLocality(pauseGuard);
+	}
+	inline void compactSimulatorIds(SimPauseGuard& pauseGuard) {
+		simulatorOptimizer.compactSimulatorIds(pauseGuard);
+	}
+	inline BatchedSimulator makeBatchedSimulator(SimPauseGuard& pauseGuard, unsigned int laneCount) {
+		return simulatorOptimizer.makeBatchedSimulator(pauseGuard, laneCount);
+	}
+	inline void clearState(SimPauseGuard& pauseGuard) {
+		simulatorOptimizer.clearState(pauseGuard);
+	}
+	inline SimulatorSnapshot takeSnapshot(SimPauseGuard& pauseGuard) {
+		return simulatorOptimizer.takeSnapshot(pauseGuard);
+	}
+	inline bool restoreSnapshot(SimPauseGuard& pauseGuard, const SimulatorSnapshot& snapshot) {
+		return simulatorOptimizer.restoreSnapshot(pauseGuard, snapshot);
+	}
+	inline unsigned int stepBack(SimPauseGuard& pauseGuard, unsigned int nTicks) {
+		return simulatorOptimizer.stepBack(pauseGuard, nTicks);
+	}
+	inline unsigned int stepForward(SimPauseGuard& pauseGuard, unsigned int nTicks) {
+		return simulatorOptimizer.stepForward(pauseGuard, nTicks);
+	}
+	inline void setWaveformRecorder(SimPauseGuard& pauseGuard, std::shared_ptr<WaveformRecorder> recorder) {
+		simulatorOptimizer.setWaveformRecorder(pauseGuard, std::move(recorder));
+	}
+
+	// gates that were replaced report the simulator id of the gate that took their place
 	inline std::optional<simulator_id_t> getSimIdFromMiddleId(middle_id_t middleId) const {
+		for (auto iter = replacedIds.find(middleId); iter != replacedIds.end(); iter = replacedIds.find(middleId)) {
+			middleId = iter->second;
+		}
 		return simulatorOptimizer.getSimIdFromMiddleId(middleId);
 	}
 
 	inline std::optional<simulator_id_t> getSimIdFromConnectionPoint(const EvalConnectionPoint& point) const {
-		return simulatorOptimizer.getSimIdFromConnectionPoint(point);
+		return simulatorOptimizer.getSimIdFromConnectionPoint(getReplacementConnectionPoint(point));
 	}
 
 	inline logic_state_t getState(EvalConnectionPoint point) const {
@@ -216,6 +349,15 @@ public:
 	inline std::vector<logic_state_t> getStatesFromSimulatorIds(const std::vector<simulator_id_t>& simulatorIds) const {
 		return simulatorOptimizer.getStatesFromSimulatorIds(simulatorIds);
 	}
+	inline state_change_feed_id_t subscribeStateChanges() {
+		return simulatorOptimizer.subscribeStateChanges();
+	}
+	inline void unsubscribeStateChanges(state_change_feed_id_t feed) {
+		simulatorOptimizer.unsubscribeStateChanges(feed);
+	}
+	inline std::vector<simulator_id_t> takeChangedSimulatorIds(state_change_feed_id_t feed) {
+		return simulatorOptimizer.takeChangedSimulatorIds(feed);
+	}
 
 	inline std::vector<SimulatorStateAndPinSimId> getSimulatorIds(const std::vector<EvalConnectionPoint>& points) const {
 		return simulatorOptimizer.getSimulatorIds(getReplacementConnectionPoints(points));
@@ -237,12 +379,16 @@ public:
 		pingOutputs(pauseGuard, connection.source.gateId);
 		pingInputs(pauseGuard, connection.destination.gateId);
 		simulatorOptimizer.makeConnection(pauseGuard, connection);
+		touchedIds.push_back(connection.source.gateId);
+		touchedIds.push_back(connection.destination.gateId);
 	}
 
 	void removeConnection(SimPauseGuard& pauseGuard, EvalConnection connection) {
 		pingOutputs(pauseGuard, connection.source.gateId);
 		pingInputs(pauseGuard, connection.destination.gateId);
 		simulatorOptimizer.removeConnection(pauseGuard, connection);
+		touchedIds.push_back(connection.source.gateId);
+		touchedIds.push_back(connection.destination.gateId);
 	}
 
 	inline double getAverageTickrate() const {
@@ -253,40 +399,117 @@ private:
 	SimulatorOptimizer simulatorOptimizer;
 	EvalConfig& evalConfig;
 	IdProvider<middle_id_t>& middleIdProvider;
-	std::vector<Replacement> replacements;
+	// replacements by replacement id, indexed by the ids they track so a ping only reverts the replacements that care
+	std::unordered_map<size_t, Replacement> replacements;
+	std::unordered_map<middle_id_t, std::vector<size_t>> replacementsTrackingOutputs;
+	std::unordered_map<middle_id_t, std::vector<size_t>> replacementsTrackingInputs;
+	size_t nextReplacementId = 0;
+	// gates changed since the last merge, only the junction groups around these can need merging
+	std::vector<middle_id_t> touchedIds;
 	std::unordered_map<middle_id_t, std::unordered_map<connection_port_id_t, EvalConnectionPoint>> replacedConnectionPoints;
 	std::unordered_map<middle_id_t, middle_id_t> replacedIds;
-	Replacement& makeReplacement() {
-		replacements.push_back(Replacement(&simulatorOptimizer, &middleIdProvider, &replacedIds, &replacedConnectionPoints));
-		return replacements.back();
-	}
-	void cleanReplacements() {
-		for (auto it = replacements.begin(); it != replacements.end();) {
-			if (it->getIsEmpty()) {
-				it = replacements.erase(it);
-			} else {
-				++it;
+	// the replacement that folded a gate into a constant, and the folds that used a gate as one of their constant inputs
+	std::unordered_map<middle_id_t, size_t> foldReplacements;
+	std::unordered_map<middle_id_t, std::vector<size_t>> foldsUsingSource;
+	// the replacement that merged a duplicate gate into an identical one
+	std::unordered_map<middle_id_t, size_t> mergedDuplicates;
+	std::unordered_set<size_t> revertingReplacements;
+	std::pair<size_t, Replacement&> makeReplacement() {
+		size_t replacementId = nextReplacementId++;
+		Replacement& replacement = replacements.emplace(
+			replacementId, Replacement(&simulatorOptimizer, &middleIdProvider, &replacedIds, &replacedConnectionPoints)
+		).first->second;
+		return { replacementId, replacement };
+	}
+	void trackReplacement(size_t replacementId, const Replacement& replacement) {
+		for (middle_id_t id : replacement.getIdsToTrackOutputs()) {
+			replacementsTrackingOutputs[id].push_back(replacementId);
+		}
+		for (middle_id_t id : replacement.getIdsToTrackInputs()) {
+			replacementsTrackingInputs[id].push_back(replacementId);
+		}
+	}
+	// reverts every replacement tracking id, entries of replacements that were already reverted are skipped
+	void pingReplacements(SimPauseGuard& pauseGuard, std::unordered_map<middle_id_t, std::vector<size_t>>& trackingReplacements, middle_id_t id) {
+		auto trackingIter = trackingReplacements.find(id);
+		if (trackingIter == trackingReplacements.end()) {
+			return;
+		}
+		std::vector<size_t> replacementIds = std::move(trackingIter->second);
+		trackingReplacements.erase(trackingIter);
+		for (size_t replacementId : replacementIds) {
+			revertReplacement(pauseGuard, replacementId);
+		}
+	}
+	// Folds and duplicate merges rewire the gates they act on, so one that sits on top of this replacement is reverted
+	// first. Those are folds that used a gate this replacement folded, and folds and merges of gates it connected.
+	void revertReplacement(SimPauseGuard& pauseGuard, size_t replacementId) {
+		auto replacementIter = replacements.find(replacementId);
+		if (replacementIter == replacements.end()) {
+			return;
+		}
+		if (!revertingReplacements.insert(replacementId).second) {
+			return;
+		}
+		const std::vector<middle_id_t> retypedIds = replacementIter->second.getRetypedIds();
+		for (middle_id_t retypedId : retypedIds) {
+			auto foldsIter = foldsUsingSource.find(retypedId);
+			if (foldsIter == foldsUsingSource.end()) {
+				continue;
+			}
+			std::vector<size_t> foldIds = std::move(foldsIter->second);
+			foldsUsingSource.erase(foldsIter);
+			for (size_t foldId : foldIds) {
+				revertReplacement(pauseGuard, foldId);
+			}
+		}
+		for (middle_id_t connectedId : replacementIter->second.getConnectedIds()) {
+			auto foldIter = foldReplacements.find(connectedId);
+			if (foldIter != foldReplacements.end() && foldIter->second != replacementId) {
+				revertReplacement(pauseGuard, foldIter->second);
+			}
+			auto mergeIter = mergedDuplicates.find(connectedId);
+			if (mergeIter != mergedDuplicates.end() && mergeIter->second != replacementId) {
+				revertReplacement(pauseGuard, mergeIter->second);
 			}
 		}
+		revertingReplacements.erase(replacementId);
+		replacementIter = replacements.find(replacementId);
+		if (replacementIter == replacements.end()) {
+			return;
+		}
+		for (middle_id_t retypedId : retypedIds) {
+			foldReplacements.erase(retypedId);
+		}
+		for (middle_id_t removedId : replacementIter->second.getRemovedIds()) {
+			auto mergeIter = mergedDuplicates.find(removedId);
+			if (mergeIter != mergedDuplicates.end() && mergeIter->second == replacementId) {
+				mergedDuplicates.erase(mergeIter);
+			}
+		}
+		replacementIter->second.appendTouchedIds(touchedIds);
+		replacementIter->second.revert(pauseGuard);
+		replacements.erase(replacementIter);
 	}
 	void pingOutputs(SimPauseGuard& pauseGuard, middle_id_t id) {
-		for (auto& replacement : replacements) {
-			replacement.pingOutput(pauseGuard, id);
-		}
+		pingReplacements(pauseGuard, replacementsTrackingOutputs, id);
 	}
 	void pingInputs(SimPauseGuard& pauseGuard, middle_id_t id) {
-		for (auto& replacement : replacements) {
-			replacement.pingInput(pauseGuard, id);
-		}
+		pingReplacements(pauseGuard, replacementsTrackingInputs, id);
 	}
+	// replacements can stack, like a merged junction group whose driver was later merged into a duplicate
 	EvalConnectionPoint getReplacementConnectionPoint(EvalConnectionPoint point) const {
-		if (replacedIds.contains(point.gateId)) {
-			return EvalConnectionPoint(replacedIds.at(point.gateId), point.portId);
-		}
-		if (replacedConnectionPoints.contains(point.gateId) && replacedConnectionPoints.at(point.gateId).contains(point.portId)) {
-			return replacedConnectionPoints.at(point.gateId).at(point.portId);
+		while (true) {
+			if (replacedIds.contains(point.gateId)) {
+				point = EvalConnectionPoint(replacedIds.at(point.gateId), point.portId);
+				continue;
+			}
+			if (replacedConnectionPoints.contains(point.gateId) && replacedConnectionPoints.at(point.gateId).contains(point.portId)) {
+				point = replacedConnectionPoints.at(point.gateId).at(point.portId);
+				continue;
+			}
+			return point;
 		}
-		return point;
 	}
 	std::vector<EvalConnectionPoint> getReplacementConnectionPoints(const std::vector<EvalConnectionPoint>& points) const {
 		std::vector<EvalConnectionPoint> result;
@@ -316,9 +539,199 @@ private:
 		std::vector<EvalConnection> connectionsToReroute;
 	};
 
-	void mergeJunctions(SimPauseGuard& pauseGuard) {
-		std::vector<middle_id_t> allMiddleIds = middleIdProvider.getUsedIds();
-		for (const middle_id_t id : allMiddleIds) {
+	// Junction groups that were not touched are already merged, so only the groups next to touched gates are flood filled.
+	// They are visited in id order like a full scan would.
+	std::set<middle_id_t> getJunctionsToMerge() {
+		std::set<middle_id_t> junctionIds;
+		for (const middle_id_t id : touchedIds) {
+			GateType gateType = simulatorOptimizer.getGateType(id);
+			if (gateType == GateType::JUNCTION) {
+				junctionIds.insert(id);
+				continue;
+			}
+			if (gateType == GateType::NONE) {
+				continue;
+			}
+			for (const auto& output : simulatorOptimizer.getOutputs(id)) {
+				if (simulatorOptimizer.getGateType(output.destination.gateId) == GateType::JUNCTION) {
+					junctionIds.insert(output.destination.gateId);
+				}
+			}
+			for (const auto& input : simulatorOptimizer.getInputs(id)) {
+				if (simulatorOptimizer.getGateType(input.source.gateId) == GateType::JUNCTION) {
+					junctionIds.insert(input.source.gateId);
+				}
+			}
+		}
+		touchedIds.clear();
+		return junctionIds;
+	}
+
+	// the state a gate drives no matter what, if it is a constant whose output is not shared with other drivers through a junction
+	std::optional<logic_state_t> getConstantOutput(middle_id_t id) const {
+		GateType gateType = simulatorOptimizer.getGateType(id);
+		if (gateType != GateType::CONSTANT_ON && gateType != GateType::CONSTANT_OFF) {
+			return std::nullopt;
+		}
+		for (const auto& output : simulatorOptimizer.getOutputs(id)) {
+			if (simulatorOptimizer.getGateType(output.destination.gateId) == GateType::JUNCTION) {
+				return std::nullopt;
+			}
+		}
+		return gateType == GateType::CONSTANT_ON ? logic_state_t::HIGH : logic_state_t::LOW;
+	}
+
+	// the constant a gate settles to when all of its inputs are constant, worked out with the simulator's own kernels
+	std::optional<GateType> getFoldedType(middle_id_t id) const {
+		GateType gateType = simulatorOptimizer.getGateType(id);
+		bool isXOR = false;
+		bool inputsInverted = false;
+		bool outputInverted = false;
+		// the same flags LogicSimulator::addGate gives the gate
+		switch (gateType) {
+		case GateType::AND: break;
+		case GateType::THROUGH: break; // a single input AND
+		case GateType::NAND: outputInverted = true; break;
+		case GateType::OR: inputsInverted = true; outputInverted = true; break;
+		case GateType::NOR: inputsInverted = true; break;
+		case GateType::XOR: isXOR = true; break;
+		case GateType::XNOR: isXOR = true; outputInverted = true; break;
+		default: return std::nullopt;
+		}
+		// an unconnected gate is most likely still being wired up, folding it would only be undone by the next edit
+		const std::vector<EvalConnection> inputs = simulatorOptimizer.getInputs(id);
+		if (inputs.empty()) {
+			return std::nullopt;
+		}
+		static const logic_state_t constantStates[2] = { logic_state_t::LOW, logic_state_t::HIGH };
+		std::vector<simulator_id_t> inputStates;
+		for (const auto& input : inputs) {
+			std::optional<logic_state_t> state = getConstantOutput(input.source.gateId);
+			if (!state.has_value()) {
+				return std::nullopt;
+			}
+			inputStates.push_back(state.value() == logic_state_t::HIGH ? 1 : 0);
+		}
+		const simulator_id_t* begin = inputStates.data();
+		const simulator_id_t* end = begin + inputStates.size();
+		logic_state_t state = isXOR ?
+			XORLikeGate::calculate(begin, end, outputInverted, constantStates) :
+			ANDLikeGate::calculate(begin, end, inputsInverted, outputInverted, constantStates);
+		return state == logic_state_t::HIGH ? GateType::CONSTANT_ON : GateType::CONSTANT_OFF;
+	}
+
+	// Turns every candidate whose inputs are all constant into a constant in place, then looks
+	// at the gates it drives. Returns true if anything was folded.
+	bool foldConstants(SimPauseGuard& pauseGuard, std::vector<middle_id_t>& candidates) {
+		bool folded = false;
+		while (!candidates.empty()) {
+			middle_id_t id = candidates.back();
+			candidates.pop_back();
+			if (foldReplacements.contains(id)) {
+				continue;
+			}
+			std::optional<GateType> constantType = getFoldedType(id);
+			if (!constantType.has_value()) {
+				continue;
+			}
+			std::vector<EvalConnection> inputs = simulatorOptimizer.getInputs(id);
+			auto [replacementId, replacement] = makeReplacement();
+			replacement.retypeGate(pauseGuard, id, constantType.value());
+			trackReplacement(replacementId, replacement);
+			foldReplacements[id] = replacementId;
+			for (const auto& input : inputs) {
+				foldsUsingSource[input.source.gateId].push_back(replacementId);
+			}
+			touchedIds.push_back(id);
+			for (const auto& output : simulatorOptimizer.getOutputs(id)) {
+				candidates.push_back(output.destination.gateId);
+			}
+			folded = true;
+		}
+		return folded;
+	}
+
+	static bool isMergeableGateType(GateType gateType) {
+		switch (gateType) {
+		case GateType::AND:
+		case GateType::OR:
+		case GateType::XOR:
+		case GateType::NAND:
+		case GateType::NOR:
+		case GateType::XNOR:
+		case GateType::THROUGH:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	// the inputs of these gate types are interchangeable, so a gate is identified by its type and its sorted drivers
+	std::vector<EvalConnectionPoint> getSortedInputSources(middle_id_t id) const {
+		std::vector<EvalConnectionPoint> sources;
+		for (const auto& input : simulatorOptimizer.getInputs(id)) {
+			sources.push_back(input.source);
+		}
+		std::sort(sources.begin(), sources.end());
+		return sources;
+	}
+
+	// Merges every candidate into a gate with the same type and the same drivers. Such a gate is only ever found among the
+	// gates its first driver feeds, so only those are hashed instead of the whole circuit. The lower id is kept and
+	// the gates fed by the merged one are looked at again, as their inputs may now match too.
+	void mergeDuplicateGates(SimPauseGuard& pauseGuard, std::vector<middle_id_t>& candidates) {
+		while (!candidates.empty()) {
+			middle_id_t id = candidates.back();
+			candidates.pop_back();
+			GateType gateType = simulatorOptimizer.getGateType(id);
+			if (!isMergeableGateType(gateType)) {
+				continue;
+			}
+			std::vector<EvalConnectionPoint> sources = getSortedInputSources(id);
+			if (sources.empty()) {
+				continue;
+			}
+			std::optional<middle_id_t> duplicateId;
+			for (const auto& sibling : simulatorOptimizer.getOutputs(sources.front().gateId)) {
+				middle_id_t siblingId = sibling.destination.gateId;
+				if (siblingId == id || simulatorOptimizer.getGateType(siblingId) != gateType) {
+					continue;
+				}
+				if (getSortedInputSources(siblingId) == sources) {
+					duplicateId = siblingId;
+					break;
+				}
+			}
+			if (!duplicateId.has_value()) {
+				continue;
+			}
+			middle_id_t keptId = std::min(id, duplicateId.value());
+			middle_id_t mergedId = std::max(id, duplicateId.value());
+			std::vector<EvalConnection> outputs = simulatorOptimizer.getOutputs(mergedId);
+
+			auto [replacementId, replacement] = makeReplacement();
+			replacement.removeGate(pauseGuard, mergedId, keptId);
+			for (const auto& output : outputs) {
+				if (output.destination.gateId == mergedId) {
+					continue;
+				}
+				replacement.makeConnection(pauseGuard, EvalConnection(EvalConnectionPoint(keptId, output.source.portId), output.destination));
+				candidates.push_back(output.destination.gateId);
+			}
+			for (const auto& source : sources) {
+				replacement.trackOutput(source.gateId);
+			}
+			replacement.trackInput(keptId);
+			trackReplacement(replacementId, replacement);
+			mergedDuplicates[mergedId] = replacementId;
+			// the kept gate may match another sibling as well
+			candidates.push_back(keptId);
+		}
+	}
+
+	// the gates the merged junctions now connect to directly are added to foldCandidates
+	void mergeJunctions(SimPauseGuard& pauseGuard, std::vector<middle_id_t>& foldCandidates) {
+		for (const middle_id_t id : getJunctionsToMerge()) {
 			if (replacedIds.contains(id)) {
 				continue;
 			}
@@ -336,7 +749,7 @@ private:
 				continue;
 			}
 
-			Replacement& replacement = makeReplacement();
+			auto [replacementId, replacement] = makeReplacement();
 			if (floodFillResult.outputsGoingIntoJunctions.size() == 1) {
 				EvalConnectionPoint output = floodFillResult.outputsGoingIntoJunctions.at(0);
 				for (const auto& junctionId : floodFillResult.junctionIds) {
@@ -344,6 +757,7 @@ private:
 				}
 				for (const auto& input : floodFillResult.inputsPullingFromJunctions) {
 					replacement.makeConnection(pauseGuard, EvalConnection(output, input.destination));
+					foldCandidates.push_back(input.destination.gateId);
 				}
 				replacement.trackOutput(output.gateId);
 			} else {
@@ -364,6 +778,7 @@ private:
 					replacement.makeConnection(pauseGuard, newConnection);
 				}
 			}
+			trackReplacement(replacementId, replacement);
 		}
 	}
 
@@ -5,18 +5,39 @@
 #include "logicState.h"
 #include "idProvider.h"
 
+// Folds the states of a range of inputs into a seen mask (see logicState.h). The loop has no data
+// dependent branches, so with CONNECTION_MACHINE_NATIVE_ARCH it is vectorized into gathers.
+inline unsigned int gatherSeenStates(const simulator_id_t* begin, const simulator_id_t* end, const logic_state_t* states) noexcept {
+	unsigned int seen = 0;
+	for (const simulator_id_t* it = begin; it != end; ++it) {
+		seen |= seenBit(states[*it]);
+	}
+	return seen;
+}
+
+// A realistic gate output only settles once it has held the same value for two ticks; a change
+// first passes through UNDEFINED.
+inline logic_state_t realisticState(logic_state_t currentState, logic_state_t targetState) noexcept {
+	if (currentState == logic_state_t::UNDEFINED) {
+		return targetState;
+	}
+	if (targetState != currentState) {
+		return logic_state_t::UNDEFINED;
+	}
+	return currentState;
+}
+
+// Gates are plain records without a vtable. LogicSimulator keeps one vector per gate type and dispatches
+// edits on SimGateType, so every gate type provides addInput, removeInput, removeIdRefs, getIdOfOutputPort,
+// resetState and remapIds itself. A gate only drives its own id.
 class SimulatorGate {
 public:
-	virtual ~SimulatorGate() = default;
-
 	SimulatorGate(simulator_id_t id) : id(id) {}
 
-	virtual void addInput(simulator_id_t inputId, connection_port_id_t portId) = 0;
-	virtual void removeInput(simulator_id_t inputId, connection_port_id_t portId) = 0;
-	virtual void removeIdRefs(simulator_id_t otherId) = 0;
-	virtual simulator_id_t getIdOfOutputPort(connection_port_id_t portId) const = 0;
-	virtual void resetState(bool realistic, std::vector<logic_state_t>& states) = 0;
-	virtual std::vector<simulator_id_t> getOutputSimIds() const = 0;
+	// oldToNew[id] is the new id of every id the gate references
+	void remapIds(const std::vector<simulator_id_t>& oldToNew) {
+		id = oldToNew[id];
+	}
 
 	simulator_id_t getId() const { return id; }
 
@@ -24,14 +45,7 @@ protected:
 	simulator_id_t id;
 
 	inline void applyRealisticTick(logic_state_t targetState, const std::vector<logic_state_t>& statesA, std::vector<logic_state_t>& statesB) noexcept {
-		logic_state_t currentState = statesA[id];
-		if (currentState == logic_state_t::UNDEFINED) {
-			statesB[id] = targetState;
-		} else if (targetState != currentState) {
-			statesB[id] = logic_state_t::UNDEFINED;
-		} else {
-			statesB[id] = currentState;
-		}
+		statesB[id] = realisticState(statesA[id], targetState);
 	}
 };
 
@@ -39,7 +53,7 @@ class LogicGate : public SimulatorGate {
 public:
 	LogicGate(simulator_id_t id) : SimulatorGate(id) {}
 
-	void resetState(bool realistic, std::vector<logic_state_t>& states) override {
+	void resetState(bool realistic, std::vector<logic_state_t>& states) {
 		if (realistic) {
 			states[id] = logic_state_t::UNDEFINED;
 		} else {
@@ -47,34 +61,37 @@ public:
 		}
 	}
 
-	simulator_id_t getIdOfOutputPort(connection_port_id_t portId) const override {
+	simulator_id_t getIdOfOutputPort(connection_port_id_t) const {
 		return id;
 	}
-
-	std::vector<simulator_id_t> getOutputSimIds() const override {
-		return {id};
-	}
 };
 
 class MultiInputGate : public LogicGate {
 public:
 	MultiInputGate(simulator_id_t id) : LogicGate(id) {}
 
-	void addInput(simulator_id_t inputId, connection_port_id_t portId) override {
+	void addInput(simulator_id_t inputId, connection_port_id_t) {
 		inputs.push_back(inputId);
 	}
 
-	void removeInput(simulator_id_t inputId, connection_port_id_t portId) override {
+	void removeInput(simulator_id_t inputId, connection_port_id_t) {
 		auto it = std::find(inputs.begin(), inputs.end(), inputId);
 		if (it != inputs.end()) {
 			inputs.erase(it);
 		}
 	}
 
-	void removeIdRefs(simulator_id_t otherId) override {
+	void removeIdRefs(simulator_id_t otherId) {
 		inputs.erase(std::remove(inputs.begin(), inputs.end(), otherId), inputs.end());
 	}
 
+	void remapIds(const std::vector<simulator_id_t>& oldToNew) {
+		LogicGate::remapIds(oldToNew);
+		for (auto& inputId : inputs) inputId = oldToNew[inputId];
+	}
+
+	const std::vector<simulator_id_t>& getInputs() const { return inputs; }
+
 protected:
 	std::vector<simulator_id_t> inputs;
 };
@@ -83,7 +100,7 @@ class SingleInputGate : public LogicGate {
 public:
 	SingleInputGate(simulator_id_t id) : LogicGate(id) {}
 
-	void addInput(simulator_id_t inputId, connection_port_id_t portId) override {
+	void addInput(simulator_id_t inputId, connection_port_id_t) {
 		if (input.has_value()) {
 			logError("SingleInputGate already has an input", "SingleInputGate::addInput");
 			return;
@@ -91,7 +108,7 @@ public:
 		input = inputId;
 	}
 
-	void removeInput(simulator_id_t inputId, connection_port_id_t portId) override {
+	void removeInput(simulator_id_t inputId, connection_port_id_t) {
 		if (input == inputId) {
 			input.reset();
 		} else {
@@ -99,12 +116,19 @@ public:
 		}
 	}
 
-	void removeIdRefs(simulator_id_t otherId) override {
+	void removeIdRefs(simulator_id_t otherId) {
 		if (input.has_value() && input.value() == otherId) {
 			input.reset();
 		}
 	}
 
+	void remapIds(const std::vector<simulator_id_t>& oldToNew) {
+		LogicGate::remapIds(oldToNew);
+		if (input.has_value()) input = oldToNew[input.value()];
+	}
+
+	std::optional<simulator_id_t> getInput() const { return input; }
+
 protected:
 	std::optional<simulator_id_t> input;
 };
@@ -118,36 +142,23 @@ struct ANDLikeGate : public MultiInputGate {
 	ANDLikeGate(simulator_id_t id, bool inputsInverted = false, bool outputInverted = false)
 		: MultiInputGate(id), inputsInverted(inputsInverted), outputInverted(outputInverted) {}
 
-	inline logic_state_t calculate(const std::vector<logic_state_t>& statesA) const noexcept {
-		if (inputs.empty()) {
+	static inline logic_state_t calculate(const simulator_id_t* begin, const simulator_id_t* end, bool inputsInverted, bool outputInverted, const logic_state_t* states) noexcept {
+		if (begin == end) {
 			return logic_state_t::LOW;
 		}
-		bool foundGoofyState = false;
-		const logic_state_t desiredState = inputsInverted ? logic_state_t::HIGH : logic_state_t::LOW;
-		for (const auto inputId : inputs) {
-			const logic_state_t state = statesA[inputId];
-			// Early-out if the decisive (desired) state is present
-			if (state == desiredState) {
-				return outputInverted ? logic_state_t::HIGH : logic_state_t::LOW;
-			}
-			// Track any unknown/floating driver; only matters if no decisive state was found
-			if (state == logic_state_t::UNDEFINED || state == logic_state_t::FLOATING) {
-				foundGoofyState = true;
-			}
+		const unsigned int seen = gatherSeenStates(begin, end, states);
+		// the decisive state wins over any unknown/floating input
+		if (seen & (inputsInverted ? SEEN_HIGH : SEEN_LOW)) {
+			return fromBool(outputInverted);
 		}
-		if (foundGoofyState) {
+		if (seen & SEEN_INVALID) {
 			return logic_state_t::UNDEFINED;
 		}
-		return outputInverted ? logic_state_t::LOW : logic_state_t::HIGH;
-	}
-
-	inline void tick(const std::vector<logic_state_t>& statesA, std::vector<logic_state_t>& statesB) noexcept {
-		statesB[id] = calculate(statesA);
+		return fromBool(!outputInverted);
 	}
 
-	inline void realisticTick(const std::vector<logic_state_t>& statesA, std::vector<logic_state_t>& statesB) noexcept {
-		logic_state_t targetState = calculate(statesA);
-		applyRealisticTick(targetState, statesA, statesB);
+	inline logic_state_t calculate(const std::vector<logic_state_t>& statesA) const noexcept {
+		return calculate(inputs.data(), inputs.data() + inputs.size(), inputsInverted, outputInverted, statesA.data());
 	}
 };
 
@@ -159,30 +170,26 @@ struct XORLikeGate : public MultiInputGate {
 	XORLikeGate(simulator_id_t id, bool outputInverted = false)
 		: MultiInputGate(id), outputInverted(outputInverted) {}
 
-	inline logic_state_t calculate(const std::vector<logic_state_t>& statesA) const noexcept {
-		if (inputs.empty()) {
+	static inline logic_state_t calculate(const simulator_id_t* begin, const simulator_id_t* end, bool outputInverted, const logic_state_t* states) noexcept {
+		if (begin == end) {
 			return logic_state_t::LOW;
 		}
-		// parity == true means current result would be HIGH
-		bool parity = outputInverted;
-		for (const auto inputId : inputs) {
-			const logic_state_t state = statesA[inputId];
-			if (state == logic_state_t::HIGH) {
-				parity = !parity;
-			} else if (state != logic_state_t::LOW) { // FLOATING or UNDEFINED
-				return logic_state_t::UNDEFINED;
-			}
+		// parity == 1 means current result would be HIGH
+		unsigned int parity = outputInverted;
+		unsigned int invalid = 0;
+		for (const simulator_id_t* it = begin; it != end; ++it) {
+			const unsigned int state = static_cast<unsigned int>(states[*it]);
+			parity ^= state & 1u;
+			invalid |= state;
 		}
-		return parity ? logic_state_t::HIGH : logic_state_t::LOW;
-	}
-
-	inline void tick(const std::vector<logic_state_t>& statesA, std::vector<logic_state_t>& statesB) noexcept {
-		statesB[id] = calculate(statesA);
+		if (invalid & 2u) { // FLOATING or UNDEFINED
+			return logic_state_t::UNDEFINED;
+		}
+		return fromBool(parity);
 	}
 
-	inline void realisticTick(const std::vector<logic_state_t>& statesA, std::vector<logic_state_t>& statesB) noexcept {
-		logic_state_t targetState = calculate(statesA);
-		applyRealisticTick(targetState, statesA, statesB);
+	inline logic_state_t calculate(const std::vector<logic_state_t>& statesA) const noexcept {
+		return calculate(inputs.data(), inputs.data() + inputs.size(), outputInverted, statesA.data());
 	}
 };
 
@@ -191,27 +198,12 @@ struct JunctionGate : public SimulatorGate {
 
 	JunctionGate(simulator_id_t id) : SimulatorGate(id) {}
 
-	inline logic_state_t calculate(const std::vector<logic_state_t>& states) const noexcept {
-		logic_state_t outputState = logic_state_t::FLOATING;
-		for (const auto inputId : inputs) {
-			const logic_state_t state = states[inputId];
-			if (state == logic_state_t::FLOATING) {
-				continue;
-			}
-			if (state == logic_state_t::UNDEFINED) {
-				return logic_state_t::UNDEFINED;
-			}
-			if (outputState == logic_state_t::FLOATING) {
-				outputState = state;
-			} else if (outputState != state) {
-				return logic_state_t::UNDEFINED;
-			}
-		}
-		return outputState;
+	static inline logic_state_t calculate(const simulator_id_t* begin, const simulator_id_t* end, const logic_state_t* states) noexcept {
+		return resolveSeenDrivers(gatherSeenStates(begin, end, states));
 	}
 
-	inline void tick(std::vector<logic_state_t>& states) noexcept {
-		states[id] = calculate(states);
+	inline logic_state_t calculate(const std::vector<logic_state_t>& states) const noexcept {
+		return calculate(inputs.data(), inputs.data() + inputs.size(), states.data());
 	}
 
 	inline void doubleTick(std::vector<logic_state_t>& statesA, std::vector<logic_state_t>& statesB) noexcept {
@@ -220,31 +212,32 @@ struct JunctionGate : public SimulatorGate {
 		statesB[id] = state;
 	}
 
-	void addInput(simulator_id_t inputId, connection_port_id_t portId) override {
+	void addInput(simulator_id_t inputId, connection_port_id_t) {
 		inputs.push_back(inputId);
 	}
 
-	void removeInput(simulator_id_t inputId, connection_port_id_t portId) override {
+	void removeInput(simulator_id_t inputId, connection_port_id_t) {
 		auto it = std::find(inputs.begin(), inputs.end(), inputId);
 		if (it != inputs.end()) {
 			inputs.erase(it);
 		}
 	}
 
-	void removeIdRefs(simulator_id_t otherId) override {
+	void removeIdRefs(simulator_id_t otherId) {
 		inputs.erase(std::remove(inputs.begin(), inputs.end(), otherId), inputs.end());
 	}
 
-	void resetState(bool realistic, std::vector<logic_state_t>& states) override {
-		states[id] = logic_state_t::FLOATING;
+	void remapIds(const std::vector<simulator_id_t>& oldToNew) {
+		SimulatorGate::remapIds(oldToNew);
+		for (auto& inputId : inputs) inputId = oldToNew[inputId];
 	}
 
-	simulator_id_t getIdOfOutputPort(connection_port_id_t portId) const override {
-		return id;
+	void resetState(bool, std::vector<logic_state_t>& states) {
+		states[id] = logic_state_t::FLOATING;
 	}
 
-	std::vector<simulator_id_t> getOutputSimIds() const override {
-		return {id};
+	simulator_id_t getIdOfOutputPort(connection_port_id_t) const {
+		return id;
 	}
 };
 
@@ -257,34 +250,66 @@ public:
 		: SingleInputGate(id), outputInverted(outputInverted) {}
 };
 
+// Passes its input on after 1 + extraDelayTicks ticks. The states still in flight wait in a ring, so a
+// long delay is one gate instead of a chain of buffers. tick advances the ring and must run once per tick.
 struct BufferGate : public BufferGateBase {
 	unsigned int extraDelayTicks;
+	std::vector<logic_state_t> delayLine; // extraDelayTicks states, the oldest at delayHead
+	unsigned int delayHead = 0;
 
 	BufferGate(simulator_id_t id, bool outputInverted = false, unsigned int extraDelayTicks = 0)
-		: BufferGateBase(id, outputInverted), extraDelayTicks(extraDelayTicks) {}
-
-	inline void tick(const std::vector<logic_state_t>& statesA, std::vector<logic_state_t>& statesB) noexcept {}
-};
-
-struct SingleBufferGate : public BufferGateBase {
-	SingleBufferGate(simulator_id_t id, bool outputInverted = false)
-		: BufferGateBase(id, outputInverted) {}
+		: BufferGateBase(id, outputInverted), extraDelayTicks(extraDelayTicks), delayLine(extraDelayTicks, logic_state_t::LOW) {}
 
 	inline logic_state_t calculate(const std::vector<logic_state_t>& statesA) const noexcept {
 		if (!input.has_value()) {
 			return logic_state_t::LOW;
 		}
-		return statesA[input.value()];
+		const logic_state_t state = statesA[input.value()];
+		if (!isValid(state)) {
+			return logic_state_t::UNDEFINED;
+		}
+		return fromBool(toBool(state) != outputInverted);
+	}
+
+	// pushes the state entering the delay line and returns the one leaving it
+	inline logic_state_t advance(logic_state_t enteringState) noexcept {
+		if (delayLine.empty()) {
+			return enteringState;
+		}
+		const logic_state_t leavingState = delayLine[delayHead];
+		delayLine[delayHead] = enteringState;
+		if (++delayHead == delayLine.size()) {
+			delayHead = 0;
+		}
+		return leavingState;
 	}
 
 	inline void tick(const std::vector<logic_state_t>& statesA, std::vector<logic_state_t>& statesB) noexcept {
-		statesB[id] = calculate(statesA);
+		statesB[id] = advance(calculate(statesA));
 	}
 
 	inline void realisticTick(const std::vector<logic_state_t>& statesA, std::vector<logic_state_t>& statesB) noexcept {
-		logic_state_t targetState = calculate(statesA);
+		logic_state_t targetState = advance(calculate(statesA));
 		applyRealisticTick(targetState, statesA, statesB);
 	}
+
+	void resetState(bool realistic, std::vector<logic_state_t>& states) {
+		LogicGate::resetState(realistic, states);
+		std::fill(delayLine.begin(), delayLine.end(), states[id]);
+		delayHead = 0;
+	}
+};
+
+struct SingleBufferGate : public BufferGateBase {
+	SingleBufferGate(simulator_id_t id, bool outputInverted = false)
+		: BufferGateBase(id, outputInverted) {}
+
+	inline logic_state_t calculate(const std::vector<logic_state_t>& statesA) const noexcept {
+		if (!input.has_value()) {
+			return logic_state_t::LOW;
+		}
+		return statesA[input.value()];
+	}
 };
 
 struct TristateBufferGate : public SimulatorGate {
@@ -295,7 +320,7 @@ struct TristateBufferGate : public SimulatorGate {
 	TristateBufferGate(simulator_id_t id, bool enableInverted = false)
 		: SimulatorGate(id), enableInverted(enableInverted) {}
 
-	void addInput(simulator_id_t inputId, connection_port_id_t portId) override {
+	void addInput(simulator_id_t inputId, connection_port_id_t portId) {
 		if (portId == 0) {
 			inputs.push_back(inputId);
 		} else {
@@ -303,7 +328,7 @@ struct TristateBufferGate : public SimulatorGate {
 		}
 	}
 
-	void removeInput(simulator_id_t inputId, connection_port_id_t portId) override {
+	void removeInput(simulator_id_t inputId, connection_port_id_t portId) {
 		if (portId == 0) {
 			auto it = std::find(inputs.begin(), inputs.end(), inputId);
 			if (it != inputs.end()) {
@@ -317,12 +342,18 @@ struct TristateBufferGate : public SimulatorGate {
 		}
 	}
 
-	void removeIdRefs(simulator_id_t otherId) override {
+	void removeIdRefs(simulator_id_t otherId) {
 		inputs.erase(std::remove(inputs.begin(), inputs.end(), otherId), inputs.end());
 		enableInputs.erase(std::remove(enableInputs.begin(), enableInputs.end(), otherId), enableInputs.end());
 	}
 
-	void resetState(bool realistic, std::vector<logic_state_t>& states) override {
+	void remapIds(const std::vector<simulator_id_t>& oldToNew) {
+		SimulatorGate::remapIds(oldToNew);
+		for (auto& inputId : inputs) inputId = oldToNew[inputId];
+		for (auto& inputId : enableInputs) inputId = oldToNew[inputId];
+	}
+
+	void resetState(bool realistic, std::vector<logic_state_t>& states) {
 		if (realistic) {
 			states[id] = logic_state_t::UNDEFINED;
 		} else {
@@ -330,77 +361,37 @@ struct TristateBufferGate : public SimulatorGate {
 		}
 	}
 
-	inline logic_state_t calculate(const std::vector<logic_state_t>& statesA) const noexcept {
-		bool foundGoofyState = false;
-		bool foundEnabled = false;
-		bool foundDisabled = false;
-		for (const auto& enableId : enableInputs) {
-			logic_state_t enableState = statesA[enableId];
-			if (enableState == logic_state_t::UNDEFINED) {
-				foundGoofyState = true;
-				break;
-			}
-			if (enableState == logic_state_t::HIGH) {
-				foundEnabled = true;
-			} else if (enableState == logic_state_t::LOW) {
-				foundDisabled = true;
-			}
-			if (foundEnabled && foundDisabled) {
-				break;
-			}
-		}
-		if (foundEnabled == foundDisabled) {
-			foundGoofyState = true;
-		}
-		if (foundGoofyState) {
+	static inline logic_state_t calculate(
+		const simulator_id_t* inputsBegin, const simulator_id_t* inputsEnd,
+		const simulator_id_t* enableBegin, const simulator_id_t* enableEnd,
+		bool enableInverted, const logic_state_t* states
+	) noexcept {
+		const unsigned int enableSeen = gatherSeenStates(enableBegin, enableEnd, states);
+		const bool foundEnabled = enableSeen & SEEN_HIGH;
+		const bool foundDisabled = enableSeen & SEEN_LOW;
+		if ((enableSeen & SEEN_UNDEFINED) || foundEnabled == foundDisabled) {
 			return logic_state_t::UNDEFINED;
 		}
 		if (foundEnabled == enableInverted) {
 			return logic_state_t::FLOATING;
 		}
-		if (inputs.empty()) {
-			return logic_state_t::UNDEFINED;
-		}
-		logic_state_t outputState = logic_state_t::FLOATING;
-		for (const auto& inputId : inputs) {
-			logic_state_t state = statesA[inputId];
-			if (state == logic_state_t::UNDEFINED) {
-				foundGoofyState = true;
-				break;
-			}
-			if (state == logic_state_t::FLOATING) {
-				continue;
-			}
-			if (outputState == logic_state_t::FLOATING) {
-				outputState = state;
-			} else if (outputState != state) {
-				outputState = logic_state_t::UNDEFINED;
-				break;
-			}
-		}
-		if (foundGoofyState) {
+		if (inputsBegin == inputsEnd) {
 			return logic_state_t::UNDEFINED;
-		} else {
-			return outputState;
 		}
+		return resolveSeenDrivers(gatherSeenStates(inputsBegin, inputsEnd, states));
 	}
 
-	inline void tick(const std::vector<logic_state_t>& statesA, std::vector<logic_state_t>& statesB) noexcept {
-		statesB[id] = calculate(statesA);
-	}
-
-	inline void realisticTick(const std::vector<logic_state_t>& statesA, std::vector<logic_state_t>& statesB) noexcept {
-		logic_state_t targetState = calculate(statesA);
-		applyRealisticTick(targetState, statesA, statesB);
+	inline logic_state_t calculate(const std::vector<logic_state_t>& statesA) const noexcept {
+		return calculate(
+			inputs.data(), inputs.data() + inputs.size(),
+			enableInputs.data(), enableInputs.data() + enableInputs.size(),
+			enableInverted, statesA.data()
+		);
 	}
 
-	simulator_id_t getIdOfOutputPort(connection_port_id_t portId) const override {
+	simulator_id_t getIdOfOutputPort(connection_port_id_t) const {
 		return id;
 	}
-
-	std::vector<simulator_id_t> getOutputSimIds() const override {
-		return {id};
-	}
 };
 
 class ConstantGateBase : public SimulatorGate {
@@ -410,23 +401,19 @@ public:
 	ConstantGateBase(simulator_id_t id, logic_state_t outputState)
 		: SimulatorGate(id), outputState(outputState) {}
 
-	void addInput(simulator_id_t inputId, connection_port_id_t portId) override {}
+	void addInput(simulator_id_t, connection_port_id_t) {}
 
-	void removeInput(simulator_id_t inputId, connection_port_id_t portId) override {}
+	void removeInput(simulator_id_t, connection_port_id_t) {}
 
-	void resetState(bool realistic, std::vector<logic_state_t>& states) override {
+	void resetState(bool, std::vector<logic_state_t>& states) {
 		states[id] = outputState;
 	}
 
-	void removeIdRefs(simulator_id_t otherId) override {}
+	void removeIdRefs(simulator_id_t) {}
 
-	simulator_id_t getIdOfOutputPort(connection_port_id_t portId) const override {
+	simulator_id_t getIdOfOutputPort(connection_port_id_t) const {
 		return id;
 	}
-
-	std::vector<simulator_id_t> getOutputSimIds() const override {
-		return {id};
-	}
 };
 
 struct ConstantGate : public ConstantGateBase {
@@ -450,11 +437,11 @@ struct ConstantResetGate : public ConstantGateBase {
 struct CopySelfOutputGate : public LogicGate {
 	CopySelfOutputGate(simulator_id_t id) : LogicGate(id) {}
 
-	void addInput(simulator_id_t inputId, connection_port_id_t portId) override {}
+	void addInput(simulator_id_t, connection_port_id_t) {}
 
-	void removeInput(simulator_id_t inputId, connection_port_id_t portId) override {}
+	void removeInput(simulator_id_t, connection_port_id_t) {}
 
-	void removeIdRefs(simulator_id_t otherId) override {}
+	void removeIdRefs(simulator_id_t) {}
 
 	inline logic_state_t calculate(const std::vector<logic_state_t>& statesA) const noexcept {
 		return statesA[id];
@@ -464,13 +451,16 @@ struct CopySelfOutputGate : public LogicGate {
 		statesB[id] = calculate(statesA);
 	}
 
-	simulator_id_t getIdOfOutputPort(connection_port_id_t portId) const override {
+	simulator_id_t getIdOfOutputPort(connection_port_id_t) const {
 		return id;
 	}
 
-	void resetState(bool realistic, std::vector<logic_state_t>& states) override {
+	void resetState(bool, std::vector<logic_state_t>& states) {
 		states[id] = logic_state_t::LOW;
 	}
 };
 
+static_assert(!std::is_polymorphic_v<ANDLikeGate> && !std::is_polymorphic_v<XORLikeGate> && !std::is_polymorphic_v<JunctionGate>);
+static_assert(!std::is_polymorphic_v<TristateBufferGate> && !std::is_polymorphic_v<ConstantGate> && !std::is_polymorphic_v<CopySelfOutputGate>);
+
 #endif /* simulatorGates_h */
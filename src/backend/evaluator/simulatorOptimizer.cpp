@@ -1,8 +1,14 @@
 #include "simulatorOptimizer.h"
 
 void SimulatorOptimizer::addGate(SimPauseGuard& pauseGuard, const GateType gateType, const middle_id_t gateId) {
-	simulator_id_t simulatorId = simulator.addGate(gateType);
+	trackGate(simulator.addGate(gateType), gateType, gateId);
+}
+
+void SimulatorOptimizer::addDelayGate(SimPauseGuard& pauseGuard, unsigned int delayTicks, const middle_id_t gateId) {
+	trackGate(simulator.addDelayGate(delayTicks), GateType::DELAY, gateId);
+}
 
+void SimulatorOptimizer::trackGate(simulator_id_t simulatorId, GateType gateType, middle_id_t gateId) {
 	// if simulatorIds is too short, extend it
 	if (simulatorIds.size() <= simulatorId) {
 		simulatorIds.resize(simulatorId + 1);
@@ -26,6 +32,31 @@ void SimulatorOptimizer::addGate(SimPauseGuard& pauseGuard, const GateType gateT
 	gateTypes[gateId] = gateType;
 }
 
+void SimulatorOptimizer::renumberForLocality(SimPauseGuard& pauseGuard) {
+	remapSimulatorIds(simulator.renumberForLocality());
+}
+
+void SimulatorOptimizer::compactSimulatorIds(SimPauseGuard& pauseGuard) {
+	remapSimulatorIds(simulator.compactIds());
+}
+
+void SimulatorOptimizer::remapSimulatorIds(const std::vector<simulator_id_t>& oldToNew) {
+	std::vector<middle_id_t> newSimulatorIds;
+	for (simulator_id_t oldId = 0; oldId < simulatorIds.size() && oldId < oldToNew.size(); ++oldId) {
+		simulator_id_t newId = oldToNew[oldId];
+		if (newId == 0) continue;
+		if (newSimulatorIds.size() <= newId) {
+			newSimulatorIds.resize(newId + 1, 0);
+		}
+		middle_id_t middleId = simulatorIds[oldId];
+		newSimulatorIds[newId] = middleId;
+		if (middleId < middleIds.size() && middleIds[middleId] == oldId) {
+			middleIds[middleId] = newId;
+		}
+	}
+	simulatorIds = std::move(newSimulatorIds);
+}
+
 void SimulatorOptimizer::removeGate(SimPauseGuard& pauseGuard, const middle_id_t gateId) {
 	// Find the gate in the simulator and remove it
 
@@ -7,6 +7,7 @@
 #include "idProvider.h"
 #include "gateType.h"
 #include "logicSimulator.h"
+#include "batchedSimulator.h"
 #include "simulatorGates.h"
 
 struct SimulatorStateAndPinSimId {
@@ -29,13 +30,49 @@ public:
 	}
 
 	void addGate(SimPauseGuard& pauseGuard, const GateType gateType, const middle_id_t gateId);
+	// a GateType::DELAY gate whose output follows its input delayTicks ticks later
+	void addDelayGate(SimPauseGuard& pauseGuard, unsigned int delayTicks, const middle_id_t gateId);
 	void removeGate(SimPauseGuard& pauseGuard, const middle_id_t gateId);
 	SimPauseGuard beginEdit() {
 		return SimPauseGuard(simulator);
 	}
 	void endEdit(SimPauseGuard& pauseGuard) {
+		if (simulator.isFragmented()) {
+			remapSimulatorIds(simulator.compactIds());
+		}
 		simulator.endEdit();
 	};
+	void renumberForLocality(SimPauseGuard& pauseGuard);
+	void compactSimulatorIds(SimPauseGuard& pauseGuard);
+	// copies the netlist and the current states into a batch with laneCount lanes
+	BatchedSimulator makeBatchedSimulator(SimPauseGuard& pauseGuard, unsigned int laneCount) {
+		simulator.processPendingStateChanges();
+		return BatchedSimulator(simulator, laneCount, evalConfig.isRealistic());
+	}
+	// state changes still queued in the simulator are applied first so they are not lost or replayed later
+	void clearState(SimPauseGuard& pauseGuard) {
+		simulator.processPendingStateChanges();
+		simulator.clearState();
+	}
+	SimulatorSnapshot takeSnapshot(SimPauseGuard& pauseGuard) {
+		simulator.processPendingStateChanges();
+		return simulator.takeSnapshot();
+	}
+	bool restoreSnapshot(SimPauseGuard& pauseGuard, const SimulatorSnapshot& snapshot) {
+		simulator.processPendingStateChanges();
+		return simulator.restoreSnapshot(snapshot);
+	}
+	unsigned int stepBack(SimPauseGuard& pauseGuard, unsigned int nTicks) {
+		simulator.processPendingStateChanges();
+		return simulator.stepBack(nTicks);
+	}
+	unsigned int stepForward(SimPauseGuard& pauseGuard, unsigned int nTicks) {
+		simulator.processPendingStateChanges();
+		return simulator.stepForward(nTicks);
+	}
+	void setWaveformRecorder(SimPauseGuard& pauseGuard, std::shared_ptr<WaveformRecorder> recorder) {
+		simulator.setWaveformRecorder(std::move(recorder));
+	}
 
 	std::optional<simulator_id_t> getSimIdFromMiddleId(middle_id_t middleId) const {
 		if (middleId < middleIds.size()) {
@@ -122,6 +159,15 @@ public:
 	inline std::vector<logic_state_t> getStatesFromSimulatorIds(const std::vector<simulator_id_t>& simulatorIds) const {
 		return simulator.getStates(simulatorIds);
 	}
+	inline state_change_feed_id_t subscribeStateChanges() {
+		return simulator.subscribeStateChanges();
+	}
+	inline void unsubscribeStateChanges(state_change_feed_id_t feed) {
+		simulator.unsubscribeStateChanges(feed);
+	}
+	inline std::vector<simulator_id_t> takeChangedSimulatorIds(state_change_feed_id_t feed) {
+		return simulator.takeChangedIds(feed);
+	}
 	std::vector<simulator_id_t> getBlockSimulatorIds(const std::vector<std::optional<EvalConnectionPoint>>& points) const {
 		std::vector<simulator_id_t> result;
 		result.reserve(points.size());
@@ -212,6 +258,9 @@ private:
 	std::vector<std::vector<EvalConnection>> inputConnections;  // inputConnections[middleId] = connections TO this gate
 	std::vector<std::vector<EvalConnection>> outputConnections; // outputConnections[middleId] = connections FROM this gate
 	std::vector<GateType> gateTypes; // maps middle_id_t to GateType
+
+	void trackGate(simulator_id_t simulatorId, GateType gateType, middle_id_t gateId);
+	void remapSimulatorIds(const std::vector<simulator_id_t>& oldToNew);
 };
 
 #endif /* simulatorOptimizer_h */
@@ -0,0 +1,99 @@
+#include "simulatorSnapshot.h"
+
+// file layout, all integers little endian as written by the host:
+// magic, version, netlistHash, state count, states, delay line count,
+// then per delay line: id, delayHead, state count, states
+namespace {
+	constexpr char snapshotMagic[8] = { 'C', 'M', 'S', 'N', 'A', 'P', 0, 0 };
+	constexpr std::uint32_t snapshotVersion = 1;
+
+	template <typename T>
+	void writeValue(std::ofstream& file, T value) {
+		file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	bool readValue(std::ifstream& file, T& value) {
+		return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+	}
+
+	void writeStates(std::ofstream& file, const std::vector<logic_state_t>& states) {
+		writeValue<std::uint64_t>(file, states.size());
+		file.write(reinterpret_cast<const char*>(states.data()), states.size() * sizeof(logic_state_t));
+	}
+
+	// maxCount keeps a corrupt count from allocating more than the file could hold
+	bool readStates(std::ifstream& file, std::vector<logic_state_t>& states, std::uint64_t maxCount) {
+		std::uint64_t count;
+		if (!readValue(file, count) || count > maxCount) return false;
+		states.resize(count);
+		if (!file.read(reinterpret_cast<char*>(states.data()), count * sizeof(logic_state_t))) return false;
+		return std::all_of(states.begin(), states.end(), [](logic_state_t state) { return static_cast<unsigned int>(state) <= 3; });
+	}
+}
+
+bool SimulatorSnapshot::save(const std::filesystem::path& path) const {
+	if (!isValid()) {
+		logError("Cannot save an empty snapshot", "SimulatorSnapshot::save");
+		return false;
+	}
+	std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		logError("Couldn't open file at path: {}", "SimulatorSnapshot::save", path.generic_string());
+		return false;
+	}
+	file.write(snapshotMagic, sizeof(snapshotMagic));
+	writeValue(file, snapshotVersion);
+	writeValue(file, netlistHash);
+	writeStates(file, *states);
+	writeValue<std::uint64_t>(file, delayLines ? delayLines->size() : 0);
+	if (delayLines) {
+		for (const DelayLine& delayLine : *delayLines) {
+			writeValue<std::uint32_t>(file, delayLine.id);
+			writeValue<std::uint32_t>(file, delayLine.delayHead);
+			writeStates(file, delayLine.states);
+		}
+	}
+	if (!file) {
+		logError("Failed to write snapshot to {}", "SimulatorSnapshot::save", path.generic_string());
+		return false;
+	}
+	return true;
+}
+
+std::optional<SimulatorSnapshot> SimulatorSnapshot::load(const std::filesystem::path& path) {
+	std::ifstream file(path, std::ios::in | std::ios::binary);
+	std::error_code error;
+	const std::uint64_t fileSize = std::filesystem::file_size(path, error);
+	if (!file.is_open() || error) {
+		logError("Couldn't open file at path: {}", "SimulatorSnapshot::load", path.generic_string());
+		return std::nullopt;
+	}
+	char magic[sizeof(snapshotMagic)];
+	std::uint32_t version;
+	if (!file.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), snapshotMagic) || !readValue(file, version) || version != snapshotVersion) {
+		logError("{} is not a simulator snapshot", "SimulatorSnapshot::load", path.generic_string());
+		return std::nullopt;
+	}
+
+	SimulatorSnapshot snapshot;
+	std::vector<logic_state_t> states;
+	std::vector<DelayLine> delayLines;
+	std::uint64_t delayLineCount;
+	bool ok = readValue(file, snapshot.netlistHash) && readStates(file, states, fileSize) && readValue(file, delayLineCount);
+	for (std::uint64_t i = 0; ok && i < delayLineCount; ++i) {
+		std::uint32_t id;
+		std::uint32_t delayHead;
+		delayLines.push_back({});
+		ok = readValue(file, id) && readValue(file, delayHead) && readStates(file, delayLines.back().states, fileSize);
+		delayLines.back().id = id;
+		delayLines.back().delayHead = delayHead;
+	}
+	if (!ok) {
+		logError("Snapshot {} is truncated or corrupt", "SimulatorSnapshot::load", path.generic_string());
+		return std::nullopt;
+	}
+	snapshot.states = std::make_shared<const std::vector<logic_state_t>>(std::move(states));
+	snapshot.delayLines = std::make_shared<const std::vector<DelayLine>>(std::move(delayLines));
+	return snapshot;
+}
@@ -0,0 +1,28 @@
+#ifndef simulatorSnapshot_h
+#define simulatorSnapshot_h
+
+#include "evalTypedef.h"
+#include "logicState.h"
+
+// Everything a LogicSimulator needs to continue from a point in time: the state of every id and the
+// contents of the delay lines. The arrays are immutable and shared, so copies of a snapshot are cheap.
+// netlistHash (LogicSimulator::getNetlistHash) ties a snapshot to the netlist it was taken from, so it
+// is only restored into a simulator running the same gates under the same ids.
+struct SimulatorSnapshot {
+	struct DelayLine {
+		simulator_id_t id;
+		unsigned int delayHead;
+		std::vector<logic_state_t> states;
+	};
+
+	std::uint64_t netlistHash = 0;
+	std::shared_ptr<const std::vector<logic_state_t>> states;
+	std::shared_ptr<const std::vector<DelayLine>> delayLines;
+
+	bool isValid() const { return states != nullptr; }
+
+	bool save(const std::filesystem::path& path) const;
+	static std::optional<SimulatorSnapshot> load(const std::filesystem::path& path);
+};
+
+#endif /* simulatorSnapshot_h */
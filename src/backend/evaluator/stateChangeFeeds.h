@@ -0,0 +1,103 @@
+#ifndef stateChangeFeeds_h
+#define stateChangeFeeds_h
+
+#include <bit>
+#include <numeric>
+
+#include "evalTypedef.h"
+
+typedef unsigned int state_change_feed_id_t;
+
+// Tells consumers which simulator ids changed state since they last asked, so a frame over a mostly idle
+// circuit only reads the few ids that moved. Every feed is a bitset over the ids that the simulation thread
+// ORs the changes of each tick into. Taking the changes swaps the bitset for an empty one, so the two sides
+// only ever wait on each other for a swap. After edits and resets a feed reports every id once.
+class StateChangeFeeds {
+public:
+	state_change_feed_id_t subscribe() {
+		std::lock_guard lock(mutex);
+		subscriberCount.fetch_add(1, std::memory_order_relaxed);
+		auto feed = std::make_unique<Feed>();
+		for (state_change_feed_id_t id = 0; id < feeds.size(); ++id) {
+			if (!feeds[id]) {
+				feeds[id] = std::move(feed);
+				return id;
+			}
+		}
+		feeds.push_back(std::move(feed));
+		return static_cast<state_change_feed_id_t>(feeds.size() - 1);
+	}
+	void unsubscribe(state_change_feed_id_t feedId) {
+		std::lock_guard lock(mutex);
+		if (feedId < feeds.size() && feeds[feedId]) {
+			feeds[feedId].reset();
+			subscriberCount.fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+	bool hasSubscribers() const { return subscriberCount.load(std::memory_order_relaxed) != 0; }
+
+	// simulation side
+	void addChanges(std::span<const simulator_id_t> ids) {
+		if (ids.empty()) return;
+		std::lock_guard lock(mutex);
+		for (auto& feed : feeds) {
+			if (!feed || feed->allChanged) continue;
+			for (simulator_id_t id : ids) {
+				const size_t word = id / 64;
+				if (word >= feed->bits.size()) feed->bits.resize(word + 1, 0);
+				feed->bits[word] |= std::uint64_t(1) << (id % 64);
+			}
+		}
+	}
+	void markAllChanged() {
+		std::lock_guard lock(mutex);
+		for (auto& feed : feeds) {
+			if (feed) feed->allChanged = true;
+		}
+	}
+
+	// Consumer side, each feed must be read from one thread at a time. Returns the changed ids in ascending
+	// order, or every id below idCount when the feed was marked as all changed.
+	std::vector<simulator_id_t> takeChanges(state_change_feed_id_t feedId, size_t idCount) {
+		Feed* feed;
+		bool allChanged;
+		{
+			std::lock_guard lock(mutex);
+			if (feedId >= feeds.size() || !feeds[feedId]) {
+				logError("No state change feed with id {}", "StateChangeFeeds::takeChanges", feedId);
+				return {};
+			}
+			feed = feeds[feedId].get();
+			// the spare bitset is always empty, the simulation thread goes on with it
+			std::swap(feed->bits, feed->spare);
+			allChanged = feed->allChanged;
+			feed->allChanged = false;
+		}
+		std::vector<simulator_id_t> ids;
+		if (allChanged) {
+			ids.resize(idCount);
+			std::iota(ids.begin(), ids.end(), simulator_id_t(0));
+		} else {
+			for (size_t word = 0; word < feed->spare.size(); ++word) {
+				for (std::uint64_t bits = feed->spare[word]; bits != 0; bits &= bits - 1) {
+					ids.push_back(static_cast<simulator_id_t>(word * 64 + std::countr_zero(bits)));
+				}
+			}
+		}
+		std::fill(feed->spare.begin(), feed->spare.end(), 0);
+		return ids;
+	}
+
+private:
+	struct Feed {
+		std::vector<std::uint64_t> bits; // written by the simulation thread under mutex
+		std::vector<std::uint64_t> spare; // owned by the consumer between takes
+		bool allChanged = true;
+	};
+
+	std::mutex mutex;
+	std::vector<std::unique_ptr<Feed>> feeds; // indexed by feed id, null once unsubscribed
+	std::atomic<unsigned int> subscriberCount { 0 };
+};
+
+#endif /* stateChangeFeeds_h */
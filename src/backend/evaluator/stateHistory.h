@@ -0,0 +1,126 @@
+#ifndef stateHistory_h
+#define stateHistory_h
+
+#include "evalTypedef.h"
+#include "logicState.h"
+
+// Ring of the last depth steps, so the simulation can be stepped back and forward again. A step is a tick or
+// a batch of states set from outside between ticks. It is stored as the ids whose state it changed, each with
+// its state before and after the step, so a record is as large as the activity of its step. Ids are written as
+// zigzag varint differences from the previous id, followed by one byte holding both states. Delay line slots
+// are recorded the same way, by buffer index.
+//
+// Steps that were stepped back stay available to step forward until the next step is recorded.
+class StateHistory {
+public:
+	unsigned int getDepth() const { return static_cast<unsigned int>(records.size()); }
+	// drops all recorded ticks
+	void setDepth(unsigned int depth) {
+		records.assign(depth, Record());
+		clear();
+	}
+	bool isEnabled() const { return !records.empty(); }
+
+	void clear() {
+		oldest = 0;
+		recordCount = 0;
+		undoneCount = 0;
+	}
+
+	unsigned int getUndoableTicks() const { return recordCount - undoneCount; }
+	unsigned int getRedoableTicks() const { return undoneCount; }
+
+	// forgets the ticks that were stepped back
+	void discardUndone() {
+		recordCount -= undoneCount;
+		undoneCount = 0;
+	}
+
+	void beginTick() {
+		discardUndone();
+		if (recordCount == records.size()) {
+			oldest = (oldest + 1) % records.size();
+			--recordCount;
+		}
+		Record& record = records[(oldest + recordCount) % records.size()];
+		record.stateChanges.clear();
+		record.delayLineChanges.clear();
+		lastStateId = 0;
+		lastDelayLineIndex = 0;
+	}
+	void addStateChange(simulator_id_t id, logic_state_t before, logic_state_t after) {
+		addChange(records[(oldest + recordCount) % records.size()].stateChanges, lastStateId, id, before, after);
+	}
+	void addDelayLineChange(size_t bufferIndex, logic_state_t before, logic_state_t after) {
+		addChange(records[(oldest + recordCount) % records.size()].delayLineChanges, lastDelayLineIndex, bufferIndex, before, after);
+	}
+	void finishTick() {
+		++recordCount;
+	}
+
+	// Calls applyState(id, state) and applyDelayLine(bufferIndex, state) with the states from before the
+	// newest recorded tick. Returns false if there is nothing left to step back.
+	template <typename ApplyState, typename ApplyDelayLine>
+	bool undoTick(ApplyState&& applyState, ApplyDelayLine&& applyDelayLine) {
+		if (getUndoableTicks() == 0) return false;
+		const Record& record = records[(oldest + recordCount - undoneCount - 1) % records.size()];
+		decode(record.stateChanges, false, applyState);
+		decode(record.delayLineChanges, false, applyDelayLine);
+		++undoneCount;
+		return true;
+	}
+
+	// the opposite of undoTick, with the states from after the oldest undone tick
+	template <typename ApplyState, typename ApplyDelayLine>
+	bool redoTick(ApplyState&& applyState, ApplyDelayLine&& applyDelayLine) {
+		if (undoneCount == 0) return false;
+		const Record& record = records[(oldest + recordCount - undoneCount) % records.size()];
+		decode(record.stateChanges, true, applyState);
+		decode(record.delayLineChanges, true, applyDelayLine);
+		--undoneCount;
+		return true;
+	}
+
+private:
+	struct Record {
+		std::vector<std::uint8_t> stateChanges;
+		std::vector<std::uint8_t> delayLineChanges;
+	};
+
+	std::vector<Record> records; // reused, so a warm ring records without allocating
+	unsigned int oldest = 0;
+	unsigned int recordCount = 0;
+	unsigned int undoneCount = 0;
+	std::uint64_t lastStateId = 0;
+	std::uint64_t lastDelayLineIndex = 0;
+
+	static void addChange(std::vector<std::uint8_t>& bytes, std::uint64_t& lastId, std::uint64_t id, logic_state_t before, logic_state_t after) {
+		const std::int64_t difference = static_cast<std::int64_t>(id - lastId);
+		std::uint64_t zigzag = (static_cast<std::uint64_t>(difference) << 1) ^ static_cast<std::uint64_t>(difference >> 63);
+		while (zigzag >= 0x80) {
+			bytes.push_back(static_cast<std::uint8_t>(zigzag) | 0x80);
+			zigzag >>= 7;
+		}
+		bytes.push_back(static_cast<std::uint8_t>(zigzag));
+		bytes.push_back(static_cast<std::uint8_t>(before) | (static_cast<std::uint8_t>(after) << 2));
+		lastId = id;
+	}
+
+	template <typename Apply>
+	static void decode(const std::vector<std::uint8_t>& bytes, bool after, Apply& apply) {
+		std::uint64_t id = 0;
+		for (size_t i = 0; i < bytes.size();) {
+			std::uint64_t zigzag = 0;
+			for (unsigned int shift = 0; ; shift += 7) {
+				const std::uint8_t byte = bytes[i++];
+				zigzag |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+				if (!(byte & 0x80)) break;
+			}
+			id += static_cast<std::uint64_t>(static_cast<std::int64_t>(zigzag >> 1) ^ -static_cast<std::int64_t>(zigzag & 1));
+			const std::uint8_t states = bytes[i++];
+			apply(id, static_cast<logic_state_t>(after ? (states >> 2) & 3 : states & 3));
+		}
+	}
+};
+
+#endif /* stateHistory_h */
@@ -1,23 +1,30 @@
 #ifndef threadPool_h
 #define threadPool_h
 
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Work stealing pool for the per tick jobs. Every round the jobs are split into one contiguous range
+// per worker, so a worker keeps running the same jobs (and touching the same part of the state
+// vectors) from tick to tick. A worker that runs out of its own range steals from the back of the
+// others. Idle workers and the waiting caller spin for a while before parking on an atomic wait, but only
+// briefly once there are at least as many workers as cores, where spinning takes the core from the thread
+// that is being waited on.
 class ThreadPool {
 public:
-	explicit ThreadPool(size_t nthreads = (std::thread::hardware_concurrency() / 2))
-		: stop(false)
-	{
-		if (nthreads == 0) nthreads = 1;
-		workers.reserve(nthreads);
-		for (size_t i = 0; i < nthreads; ++i) spawnOne();
+	explicit ThreadPool(size_t nthreads = (std::thread::hardware_concurrency() / 2)) {
+		startWorkers(std::max(nthreads, size_t(1)));
 	}
 
 	~ThreadPool() {
 		// Ensure all jobs have fully finished (not just claimed)
 		waitForCompletion();
-		stop.store(true, std::memory_order_relaxed);
-		for (auto& w : workers) w->retire.store(true, std::memory_order_relaxed);
-		cv.notify_all(); // wake any sleepers
-		for (auto& w : workers) if (w->th.joinable()) w->th.join();
+		stopWorkers();
 	}
 
 	struct Job {
@@ -26,114 +33,207 @@ public:
 	};
 
 	// Load a new round that references the caller-owned jobs (no copy/move).
-	void resetAndLoad(const std::vector<Job>& new_jobs) {
-		{
-			std::lock_guard lk(mtx);
-			jobsRef = &new_jobs;
-			next.store(0, std::memory_order_relaxed);
-			completed.store(0, std::memory_order_relaxed);
-			end.store(static_cast<uint32_t>(new_jobs.size()), std::memory_order_release);
-			round.fetch_add(1, std::memory_order_release);
+	// The previous round has to be complete.
+	void resetAndLoad(const std::vector<Job>& newJobs) {
+		jobsRef = &newJobs;
+		const uint32_t jobCount = static_cast<uint32_t>(newJobs.size());
+		completed.store(0, std::memory_order_relaxed);
+		end.store(jobCount, std::memory_order_relaxed);
+		const size_t workerCount = workers.size();
+		for (size_t i = 0; i < workerCount; ++i) {
+			const uint32_t head = static_cast<uint32_t>(jobCount * i / workerCount);
+			const uint32_t tail = static_cast<uint32_t>(jobCount * (i + 1) / workerCount);
+			workers[i]->range.store(packRange(head, tail), std::memory_order_release);
 		}
-		cv.notify_all();
+		round.fetch_add(1, std::memory_order_release);
+		round.notify_all();
 	}
 
 	void waitForEmpty() {
-		while (true) {
-			uint32_t n = next.load(std::memory_order_acquire);
-			uint32_t e = end.load(std::memory_order_acquire);
-			if (n >= e) break;
-			std::this_thread::yield();
+		for (const auto& w : workers) {
+			while (rangeHead(w->range.load(std::memory_order_acquire)) < rangeTail(w->range.load(std::memory_order_acquire))) {
+				cpuRelax();
+				std::this_thread::yield();
+			}
 		}
 	}
 
 	void waitForCompletion() {
+		auto isDone = [this] {
+			return completed.load(std::memory_order_acquire) >= end.load(std::memory_order_acquire);
+		};
+		if (spinUntil(isDone, callerSpinLimit)) return;
 		while (true) {
 			uint32_t c = completed.load(std::memory_order_acquire);
-			uint32_t e = end.load(std::memory_order_acquire);
-			if (c >= e) break;
-			std::this_thread::yield();
+			if (c >= end.load(std::memory_order_acquire)) break;
+			completed.wait(c, std::memory_order_acquire);
 		}
 	}
 
-	void resizeThreads(size_t new_count) {
-		size_t cur = workers.size();
-		new_count = std::max(new_count, size_t(1));
-		if (new_count > cur) {
-			size_t add = new_count - cur;
-			workers.reserve(workers.size() + add);
-			for (size_t i = 0; i < add; ++i) spawnOne();
-			return;
-		}
-		if (new_count < cur) {
-			size_t kill = cur - new_count;
-			waitForCompletion();
-			for (size_t i = 0; i < kill; ++i)
-				workers[workers.size() - 1 - i]->retire.store(true, std::memory_order_relaxed);
-			cv.notify_all(); // wake sleepers so they can retire
-			for (size_t i = 0; i < kill; ++i) {
-				auto idx = workers.size() - 1;
-				auto& w = workers[idx];
-				if (w->th.joinable()) w->th.join();
-				workers.pop_back();
-			}
-		}
+	void resizeThreads(size_t newCount) {
+		newCount = std::max(newCount, size_t(1));
+		if (newCount == workers.size() && pinnedWorkers == pinThreads) return;
+		waitForCompletion();
+		stopWorkers();
+		startWorkers(newCount);
 	}
 
+	// pins worker i to core i. takes effect on the next resizeThreads
+	void setPinThreads(bool pin) { pinThreads = pin; }
+
 	size_t threadCount() const { return workers.size(); }
 
 private:
-	struct Worker {
+	static constexpr uint32_t minSpin = 64;
+	static constexpr uint32_t maxSpin = 1 << 14;
+
+	struct alignas(64) Worker {
 		std::thread th;
-		std::atomic<bool> retire{false};
+		std::atomic<uint64_t> range { 0 }; // claimable jobs, head in the low and tail in the high 32 bits
+		uint32_t spinLimit = minSpin;
+		size_t index = 0;
 	};
 
-	void spawnOne() {
-		auto w = std::make_unique<Worker>();
-		Worker* self = w.get();
-		w->th = std::thread([this, self]{ workerLoop(self); });
-		workers.emplace_back(std::move(w));
+	static uint64_t packRange(uint32_t head, uint32_t tail) { return (static_cast<uint64_t>(tail) << 32) | head; }
+	static uint32_t rangeHead(uint64_t range) { return static_cast<uint32_t>(range); }
+	static uint32_t rangeTail(uint64_t range) { return static_cast<uint32_t>(range >> 32); }
+
+	static inline void cpuRelax() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+		_mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+		asm volatile("yield");
+#endif
+	}
+
+	// Spins until done() or the spin limit runs out. The limit grows when spinning pays off and
+	// shrinks when we end up parking anyway. Yields now and then so a thread without a core of its own
+	// still gets to run.
+	template <typename Done>
+	bool spinUntil(Done&& done, uint32_t& spinLimit) const {
+		spinLimit = std::min(spinLimit, spinCap);
+		for (uint32_t i = 0; i < spinLimit; ++i) {
+			if (done()) {
+				spinLimit = std::min(spinLimit * 2, spinCap);
+				return true;
+			}
+			cpuRelax();
+			if (i % 16 == 15) std::this_thread::yield();
+		}
+		spinLimit = std::max(spinLimit / 2, minSpin);
+		return done();
+	}
+
+	// owner side, takes from the front
+	static bool popFront(std::atomic<uint64_t>& range, uint32_t& job) {
+		uint64_t current = range.load(std::memory_order_acquire);
+		while (rangeHead(current) < rangeTail(current)) {
+			if (range.compare_exchange_weak(current, packRange(rangeHead(current) + 1, rangeTail(current)), std::memory_order_acq_rel)) {
+				job = rangeHead(current);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// thief side, takes from the back
+	static bool popBack(std::atomic<uint64_t>& range, uint32_t& job) {
+		uint64_t current = range.load(std::memory_order_acquire);
+		while (rangeHead(current) < rangeTail(current)) {
+			if (range.compare_exchange_weak(current, packRange(rangeHead(current), rangeTail(current) - 1), std::memory_order_acq_rel)) {
+				job = rangeTail(current) - 1;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void runJob(uint32_t i) {
+		// Safe because resetAndLoad keeps jobsRef stable for the round.
+		const Job j = (*jobsRef)[i];
+		j.fn(j.arg);
+		if (completed.fetch_add(1, std::memory_order_acq_rel) + 1 == end.load(std::memory_order_acquire)) {
+			completed.notify_all();
+		}
+	}
+
+	bool runAvailableJobs(Worker* self) {
+		bool didWork = false;
+		uint32_t job;
+		while (popFront(self->range, job)) {
+			runJob(job);
+			didWork = true;
+		}
+		const size_t workerCount = workers.size();
+		for (size_t k = 1; k < workerCount; ++k) {
+			Worker* victim = workers[(self->index + k) % workerCount].get();
+			while (popBack(victim->range, job)) {
+				runJob(job);
+				didWork = true;
+			}
+		}
+		return didWork;
 	}
 
 	void workerLoop(Worker* self) {
-		uint64_t local_round = round.load(std::memory_order_acquire);
+		uint64_t localRound = round.load(std::memory_order_acquire);
 		while (true) {
-			// Claim an index.
-			uint32_t i = next.fetch_add(1, std::memory_order_acq_rel);
-			uint32_t e = end.load(std::memory_order_acquire);
-
-			if (i < e) {
-				// Safe because resetAndLoad keeps jobsRef stable for the round.
-				const Job j = (*jobsRef)[i];
-				j.fn(j.arg);
-				completed.fetch_add(1, std::memory_order_acq_rel);
-				continue;
+			if (runAvailableJobs(self)) continue;
+			if (stop.load(std::memory_order_acquire)) return;
+
+			auto roundChanged = [this, localRound] { return round.load(std::memory_order_acquire) != localRound; };
+			if (!spinUntil(roundChanged, self->spinLimit)) {
+				round.wait(localRound, std::memory_order_acquire);
 			}
+			localRound = round.load(std::memory_order_acquire);
+		}
+	}
 
-			std::unique_lock lk(mtx);
-			cv.wait(lk, [this, self, &local_round]{
-				return self->retire.load(std::memory_order_relaxed)
-					   || stop.load(std::memory_order_relaxed)
-					   || round.load(std::memory_order_acquire) != local_round;
-			});
-			if (self->retire.load(std::memory_order_relaxed) ||
-				stop.load(std::memory_order_relaxed)) {
-				return;
+	// the worker vector is only changed while no worker thread is running, so workers can scan it
+	// for steal victims without locking
+	void startWorkers(size_t count) {
+		stop.store(false, std::memory_order_relaxed);
+		workers.reserve(count);
+		for (size_t i = 0; i < count; ++i) {
+			workers.emplace_back(std::make_unique<Worker>());
+			workers.back()->index = i;
+		}
+		const unsigned int cores = std::max(std::thread::hardware_concurrency(), 1u);
+		spinCap = workers.size() >= cores ? minSpin : maxSpin;
+		callerSpinLimit = minSpin;
+		for (auto& w : workers) {
+			Worker* self = w.get();
+			w->th = std::thread([this, self] { workerLoop(self); });
+			if (pinThreads) {
+#if defined(__linux__)
+				cpu_set_t cpuSet;
+				CPU_ZERO(&cpuSet);
+				CPU_SET(self->index % cores, &cpuSet);
+				pthread_setaffinity_np(w->th.native_handle(), sizeof(cpuSet), &cpuSet);
+#endif
 			}
-			local_round = round.load(std::memory_order_acquire);
 		}
+		pinnedWorkers = pinThreads;
+	}
+
+	void stopWorkers() {
+		stop.store(true, std::memory_order_release);
+		round.fetch_add(1, std::memory_order_release);
+		round.notify_all(); // wake sleepers so they can exit
+		for (auto& w : workers) if (w->th.joinable()) w->th.join();
+		workers.clear();
 	}
 
 	std::vector<std::unique_ptr<Worker>> workers;
-	const std::vector<Job>* jobsRef{nullptr}; // reference to current round’s jobs
-	std::atomic<uint32_t> next{0};          // next index to claim
-	std::atomic<uint32_t> end{0};           // jobsRef->size()
-	std::atomic<uint32_t> completed{0};      // number of jobs fully executed
-	std::atomic<bool> stop{false};          // global shutdown (idle-only)
-	std::atomic<uint64_t> round{0};         // generation/epoch for cv wakeups
-
-	std::mutex mtx;
-	std::condition_variable cv;
+	const std::vector<Job>* jobsRef { nullptr }; // reference to current round's jobs
+	std::atomic<uint32_t> end { 0 };            // jobsRef->size()
+	std::atomic<uint32_t> completed { 0 };      // number of jobs fully executed
+	std::atomic<bool> stop { false };           // shutdown of all workers
+	std::atomic<uint64_t> round { 0 };          // generation/epoch for wakeups
+	uint32_t callerSpinLimit = minSpin;
+	uint32_t spinCap = maxSpin; // maxSpin, or minSpin when the workers alone fill every core
+	bool pinThreads = false;
+	bool pinnedWorkers = false;
 };
 
 #endif /* threadPool_h */
@@ -0,0 +1,225 @@
+#include "waveformRecorder.h"
+
+// Binary layout: magic, signal count, per signal its name length and name, then per tick with changes the
+// varint tick difference to the previous such tick, the varint change count and per change the varint
+// signalIndex << 2 | state. Integers outside the varints are little endian as written by the host.
+namespace {
+	constexpr char waveformMagic[8] = { 'C', 'M', 'W', 'A', 'V', 'E', 0, 1 };
+
+	void writeVarint(std::ofstream& file, std::uint64_t value) {
+		char bytes[10];
+		unsigned int count = 0;
+		while (value >= 0x80) {
+			bytes[count++] = static_cast<char>(static_cast<std::uint8_t>(value) | 0x80);
+			value >>= 7;
+		}
+		bytes[count++] = static_cast<char>(value);
+		file.write(bytes, count);
+	}
+
+	// VCD identifiers are strings of the printable characters '!' to '~'
+	std::string vcdIdentifier(size_t index) {
+		std::string identifier;
+		do {
+			identifier.push_back(static_cast<char>('!' + index % 94));
+			index /= 94;
+		} while (index != 0);
+		return identifier;
+	}
+
+	// VCD reference names cannot hold whitespace
+	std::string vcdReference(const std::string& name) {
+		std::string reference;
+		for (char c : name) {
+			if (c == ' ') continue;
+			reference.push_back(c < '!' || c > '~' ? '_' : c);
+		}
+		return reference.empty() ? "_" : reference;
+	}
+
+	char vcdValue(logic_state_t state) {
+		switch (state) {
+		case logic_state_t::LOW: return '0';
+		case logic_state_t::HIGH: return '1';
+		case logic_state_t::FLOATING: return 'z';
+		default: return 'x';
+		}
+	}
+}
+
+WaveformRecorder::WaveformRecorder(std::vector<WaveformSignal> signals, WaveformFormat format) :
+	signals(std::move(signals)), format(format) {
+	for (const WaveformSignal& signal : this->signals) {
+		ids.push_back(signal.simulatorId);
+		maxId = std::max(maxId, signal.simulatorId);
+	}
+	currentStates.resize(ids.size());
+	// no real state matches, so the first sample records every signal
+	previousStates.assign(ids.size(), static_cast<logic_state_t>(0xff));
+	currentChunk = std::make_unique<Chunk>();
+	currentChunk->changes.reserve(chunkCapacity);
+}
+
+WaveformRecorder::~WaveformRecorder() {
+	stop();
+}
+
+bool WaveformRecorder::start(const std::filesystem::path& path) {
+	file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		logError("Couldn't open file at path: {}", "WaveformRecorder::start", path.generic_string());
+		return false;
+	}
+	writerThread = std::thread(&WaveformRecorder::writerLoop, this);
+	return true;
+}
+
+void WaveformRecorder::stop() {
+	if (!writerThread.joinable()) return;
+	flush();
+	stopping.store(true, std::memory_order_release);
+	writerThread.join();
+	// flush keeps the chunk when the ring is full, the writer has written everything before it by now
+	if (!currentChunk->changes.empty()) {
+		writeChunk(*currentChunk);
+		currentChunk->changes.clear();
+		file.flush();
+		if (!file) {
+			logError("Failed to write the waveform", "WaveformRecorder::stop");
+		}
+	}
+	deleteChunks(filledChunks);
+	deleteChunks(freeChunks);
+	file.close();
+}
+
+void WaveformRecorder::sample(const std::vector<logic_state_t>& states) {
+	const std::uint64_t tick = sampleCount++;
+	if (maxId < states.size()) {
+		for (size_t i = 0; i < ids.size(); ++i) {
+			currentStates[i] = states[ids[i]];
+		}
+	} else {
+		for (size_t i = 0; i < ids.size(); ++i) {
+			currentStates[i] = ids[i] < states.size() ? states[ids[i]] : logic_state_t::UNDEFINED;
+		}
+	}
+	// most ticks change none of the watched signals, a single wide compare settles those
+	if (std::memcmp(currentStates.data(), previousStates.data(), ids.size() * sizeof(logic_state_t)) == 0) return;
+
+	for (size_t i = 0; i < ids.size(); ++i) {
+		if (currentStates[i] != previousStates[i]) {
+			currentChunk->changes.push_back({ tick, static_cast<std::uint32_t>(i), currentStates[i] });
+		}
+	}
+	std::swap(currentStates, previousStates);
+	if (currentChunk->changes.size() >= chunkCapacity) flush();
+}
+
+void WaveformRecorder::flush() {
+	if (currentChunk->changes.empty() || !writerThread.joinable()) return;
+	// when the writer is behind and the ring is full, the chunk keeps growing until the next flush
+	if (!filledChunks.push(currentChunk.get())) return;
+	currentChunk.release();
+	Chunk* chunk = freeChunks.pop();
+	currentChunk.reset(chunk ? chunk : new Chunk());
+	currentChunk->changes.reserve(chunkCapacity);
+}
+
+void WaveformRecorder::remapIds(const std::vector<simulator_id_t>& oldToNew) {
+	maxId = 0;
+	for (simulator_id_t& id : ids) {
+		id = id < oldToNew.size() && oldToNew[id] != 0 ? oldToNew[id] : missingId;
+		maxId = std::max(maxId, id);
+	}
+}
+
+void WaveformRecorder::setIds(const std::vector<simulator_id_t>& simulatorIds) {
+	maxId = 0;
+	for (size_t i = 0; i < ids.size(); ++i) {
+		ids[i] = i < simulatorIds.size() && simulatorIds[i] != 0 ? simulatorIds[i] : missingId;
+		maxId = std::max(maxId, ids[i]);
+	}
+}
+
+void WaveformRecorder::writerLoop() {
+	writeHeader();
+	while (true) {
+		Chunk* chunk = filledChunks.pop();
+		if (chunk == nullptr) {
+			// stop flushes before it sets stopping, so an empty ring after stopping has been seen is final
+			if (stopping.load(std::memory_order_acquire) && (chunk = filledChunks.pop()) == nullptr) break;
+			if (chunk == nullptr) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				continue;
+			}
+		}
+		writeChunk(*chunk);
+		chunk->changes.clear();
+		if (!freeChunks.push(chunk)) delete chunk;
+	}
+	file.flush();
+	if (!file) {
+		logError("Failed to write the waveform", "WaveformRecorder::writerLoop");
+	}
+}
+
+void WaveformRecorder::writeHeader() {
+	if (format == WaveformFormat::BINARY) {
+		file.write(waveformMagic, sizeof(waveformMagic));
+		const std::uint32_t signalCount = static_cast<std::uint32_t>(signals.size());
+		file.write(reinterpret_cast<const char*>(&signalCount), sizeof(signalCount));
+		for (const WaveformSignal& signal : signals) {
+			const std::uint32_t nameLength = static_cast<std::uint32_t>(signal.name.size());
+			file.write(reinterpret_cast<const char*>(&nameLength), sizeof(nameLength));
+			file.write(signal.name.data(), nameLength);
+		}
+		return;
+	}
+	file << "$timescale 1 ns $end\n$scope module top $end\n";
+	for (size_t i = 0; i < signals.size(); ++i) {
+		file << "$var wire 1 " << vcdIdentifier(i) << ' ' << vcdReference(signals[i].name) << " $end\n";
+	}
+	file << "$upscope $end\n$enddefinitions $end\n";
+}
+
+void WaveformRecorder::writeChunk(const Chunk& chunk) {
+	if (format == WaveformFormat::BINARY) {
+		writeBinary(chunk);
+	} else {
+		writeVCD(chunk);
+	}
+}
+
+void WaveformRecorder::writeVCD(const Chunk& chunk) {
+	for (const Change& change : chunk.changes) {
+		if (!wroteTick || change.tick != lastWrittenTick) {
+			file << '#' << change.tick << '\n';
+			lastWrittenTick = change.tick;
+			wroteTick = true;
+		}
+		file << vcdValue(change.state) << vcdIdentifier(change.signalIndex) << '\n';
+	}
+}
+
+void WaveformRecorder::writeBinary(const Chunk& chunk) {
+	for (size_t i = 0; i < chunk.changes.size();) {
+		const std::uint64_t tick = chunk.changes[i].tick;
+		size_t end = i;
+		while (end < chunk.changes.size() && chunk.changes[end].tick == tick) ++end;
+		// the changes of one tick can be split over two chunks, which just writes the tick twice
+		writeVarint(file, wroteTick ? tick - lastWrittenTick : tick);
+		writeVarint(file, end - i);
+		for (; i < end; ++i) {
+			writeVarint(file, (static_cast<std::uint64_t>(chunk.changes[i].signalIndex) << 2) | static_cast<std::uint64_t>(chunk.changes[i].state));
+		}
+		lastWrittenTick = tick;
+		wroteTick = true;
+	}
+}
+
+void WaveformRecorder::deleteChunks(ChunkRing& ring) {
+	while (Chunk* chunk = ring.pop()) {
+		delete chunk;
+	}
+}
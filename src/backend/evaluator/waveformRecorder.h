@@ -0,0 +1,108 @@
+#ifndef waveformRecorder_h
+#define waveformRecorder_h
+
+#include "evalTypedef.h"
+#include "logicState.h"
+
+enum class WaveformFormat {
+	VCD, // value change dump, readable by GTKWave and most waveform viewers
+	BINARY // compact varint stream, see WaveformRecorder::writeBinary
+};
+
+struct WaveformSignal {
+	std::string name;
+	simulator_id_t simulatorId;
+};
+
+// Streams the states of a set of simulator ids to a waveform file. LogicSimulator calls sample once per tick
+// on the simulation thread. The changes are collected in chunks that are handed to a writer thread through
+// a lock free single producer, single consumer ring, so the tick loop never waits on the file. If the writer
+// falls behind, the current chunk keeps growing instead of blocking the tick.
+class WaveformRecorder {
+public:
+	WaveformRecorder(std::vector<WaveformSignal> signals, WaveformFormat format);
+	WaveformRecorder(const WaveformRecorder&) = delete;
+	WaveformRecorder& operator=(const WaveformRecorder&) = delete;
+	~WaveformRecorder();
+
+	// opens the file and starts the writer thread
+	bool start(const std::filesystem::path& path);
+	// hands the remaining changes to the writer, waits for it to write them and closes the file
+	void stop();
+
+	// simulation side, called with the states after a tick. The first sample records every signal
+	void sample(const std::vector<logic_state_t>& states);
+	// simulation side, makes the changes collected so far visible to the writer
+	void flush();
+	// simulation side, oldToNew[id] is the new id of id (see LogicSimulator::renumberForLocality)
+	void remapIds(const std::vector<simulator_id_t>& oldToNew);
+	// only while the simulation is paused, the current id of every signal. Signals with id 0 record undefined
+	void setIds(const std::vector<simulator_id_t>& simulatorIds);
+
+	std::uint64_t getSampleCount() const { return sampleCount; }
+
+private:
+	struct Change {
+		std::uint64_t tick;
+		std::uint32_t signalIndex;
+		logic_state_t state;
+	};
+	struct Chunk {
+		std::vector<Change> changes;
+	};
+
+	// Fixed size ring for one producer and one consumer thread. push fails when full, pop when empty.
+	class ChunkRing {
+	public:
+		bool push(Chunk* chunk) {
+			const size_t tail = this->tail.load(std::memory_order_relaxed);
+			if (tail - head.load(std::memory_order_acquire) == slots.size()) return false;
+			slots[tail % slots.size()] = chunk;
+			this->tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+		Chunk* pop() {
+			const size_t head = this->head.load(std::memory_order_relaxed);
+			if (head == tail.load(std::memory_order_acquire)) return nullptr;
+			Chunk* chunk = slots[head % slots.size()];
+			this->head.store(head + 1, std::memory_order_release);
+			return chunk;
+		}
+
+	private:
+		std::array<Chunk*, 256> slots {};
+		std::atomic<size_t> head { 0 };
+		std::atomic<size_t> tail { 0 };
+	};
+
+	static constexpr size_t chunkCapacity = 1 << 16;
+	// past the end of every state vector, so sample reads it as undefined
+	static constexpr simulator_id_t missingId = std::numeric_limits<simulator_id_t>::max();
+
+	std::vector<WaveformSignal> signals;
+	WaveformFormat format;
+	std::vector<simulator_id_t> ids;
+	simulator_id_t maxId = 0;
+	std::vector<logic_state_t> previousStates;
+	std::vector<logic_state_t> currentStates;
+	std::uint64_t sampleCount = 0;
+	std::unique_ptr<Chunk> currentChunk;
+
+	ChunkRing filledChunks; // simulation thread to writer
+	ChunkRing freeChunks; // writer back to the simulation thread, so chunks are reused
+	std::atomic<bool> stopping { false };
+	std::thread writerThread;
+	std::ofstream file;
+
+	void writerLoop();
+	void writeHeader();
+	void writeChunk(const Chunk& chunk);
+	void writeVCD(const Chunk& chunk);
+	void writeBinary(const Chunk& chunk);
+	void deleteChunks(ChunkRing& ring);
+
+	std::uint64_t lastWrittenTick = 0;
+	bool wroteTick = false;
+};
+
+#endif /* waveformRecorder_h */
@@ -0,0 +1,118 @@
+#include "evalSimulatorTest.h"
+
+void EvalSimulatorTest::TearDown() {
+	// the simulator subscribes to its config, so it has to go first
+	evalSimulator.reset();
+	evalConfig.reset();
+}
+
+void EvalSimulatorTest::start(EvaluationMode mode) {
+	TearDown();
+	evalConfig = std::make_unique<EvalConfig>();
+	evalConfig->setEvaluationMode(mode);
+	evalConfig->setHistoryDepth(8);
+	evalSimulator = std::make_unique<EvalSimulator>(*evalConfig, middleIdProvider, dirtySimulatorIds);
+}
+
+middle_id_t EvalSimulatorTest::addGate(GateType gateType) {
+	middle_id_t gateId = middleIdProvider.getNewId();
+	SimPauseGuard pauseGuard = evalSimulator->beginEdit();
+	evalSimulator->addGate(pauseGuard, gateType, gateId);
+	return gateId;
+}
+
+middle_id_t EvalSimulatorTest::addDelayGate(unsigned int delayTicks) {
+	middle_id_t gateId = middleIdProvider.getNewId();
+	SimPauseGuard pauseGuard = evalSimulator->beginEdit();
+	evalSimulator->addDelayGate(pauseGuard, delayTicks, gateId);
+	return gateId;
+}
+
+void EvalSimulatorTest::connect(middle_id_t source, middle_id_t destination) {
+	SimPauseGuard pauseGuard = evalSimulator->beginEdit();
+	evalSimulator->makeConnection(pauseGuard, EvalConnection(source, 0, destination, 0));
+}
+
+void EvalSimulatorTest::endEdit() {
+	SimPauseGuard pauseGuard = evalSimulator->beginEdit();
+	evalSimulator->endEdit(pauseGuard);
+}
+
+void EvalSimulatorTest::tick(unsigned int nTicks) {
+	evalConfig->addSprint(nTicks);
+	evalConfig->waitForSprintComplete();
+}
+
+void EvalSimulatorTest::setState(middle_id_t gateId, logic_state_t state) {
+	evalSimulator->setState(EvalConnectionPoint(gateId, 0), state);
+}
+
+logic_state_t EvalSimulatorTest::getState(middle_id_t gateId) const {
+	return evalSimulator->getState(EvalConnectionPoint(gateId, 0));
+}
+
+TEST_F(EvalSimulatorTest, MultiTickDelay) {
+	for (EvaluationMode mode : { EvaluationMode::FULL, EvaluationMode::EVENT_DRIVEN, EvaluationMode::LEVELIZED }) {
+		SCOPED_TRACE(static_cast<int>(mode));
+		start(mode);
+		middle_id_t input = addGate(GateType::DUMMY_INPUT);
+		middle_id_t delay = addDelayGate(3);
+		connect(input, delay);
+		endEdit();
+		tick(4);
+		ASSERT_EQ(getState(delay), logic_state_t::LOW);
+
+		setState(input, logic_state_t::HIGH);
+		tick(2);
+		ASSERT_EQ(getState(delay), logic_state_t::LOW);
+		tick(1);
+		ASSERT_EQ(getState(delay), logic_state_t::HIGH);
+
+		// a snapshot taken while the change travels down the delay line carries it
+		setState(input, logic_state_t::LOW);
+		tick(1);
+		SimulatorSnapshot snapshot;
+		{
+			SimPauseGuard pauseGuard = evalSimulator->beginEdit();
+			snapshot = evalSimulator->takeSnapshot(pauseGuard);
+		}
+		tick(2);
+		ASSERT_EQ(getState(delay), logic_state_t::LOW);
+		{
+			SimPauseGuard pauseGuard = evalSimulator->beginEdit();
+			ASSERT_TRUE(evalSimulator->restoreSnapshot(pauseGuard, snapshot));
+		}
+		ASSERT_EQ(getState(delay), logic_state_t::HIGH);
+		tick(1);
+		ASSERT_EQ(getState(delay), logic_state_t::HIGH);
+		tick(1);
+		ASSERT_EQ(getState(delay), logic_state_t::LOW);
+
+		// stepping back rewinds the delay line with the states
+		setState(input, logic_state_t::HIGH);
+		tick(3);
+		ASSERT_EQ(getState(delay), logic_state_t::HIGH);
+		{
+			SimPauseGuard pauseGuard = evalSimulator->beginEdit();
+			ASSERT_EQ(evalSimulator->stepBack(pauseGuard, 2), 2);
+		}
+		ASSERT_EQ(getState(delay), logic_state_t::LOW);
+		tick(1);
+		ASSERT_EQ(getState(delay), logic_state_t::LOW);
+		tick(1);
+		ASSERT_EQ(getState(delay), logic_state_t::HIGH);
+
+		// the batched lanes start out with the same delay line and then go their own ways
+		std::vector<simulator_id_t> ids = evalSimulator->getBlockSimulatorIds({ EvalConnectionPoint(input, 0), EvalConnectionPoint(delay, 0) });
+		BatchedSimulator batch = [&] {
+			SimPauseGuard pauseGuard = evalSimulator->beginEdit();
+			return evalSimulator->makeBatchedSimulator(pauseGuard, 2);
+		}();
+		batch.setState(0, ids[0], logic_state_t::LOW);
+		batch.tick(2);
+		ASSERT_EQ(batch.getState(0, ids[1]), logic_state_t::HIGH);
+		batch.tick(1);
+		ASSERT_EQ(batch.getState(0, ids[1]), logic_state_t::LOW);
+		ASSERT_EQ(batch.getState(1, ids[1]), logic_state_t::HIGH);
+	}
+}
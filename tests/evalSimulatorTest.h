@@ -0,0 +1,28 @@
+#ifndef evalSimulatorTest_h
+#define evalSimulatorTest_h
+
+#include <gtest/gtest.h>
+#include "backend/evaluator/evalSimulator.h"
+
+// Drives the simulation pipeline below the Evaluator directly, for gates no block type places
+class EvalSimulatorTest : public ::testing::Test {
+protected:
+	void TearDown() override;
+	// replaces the simulator with an empty one evaluating in mode
+	void start(EvaluationMode mode);
+	middle_id_t addGate(GateType gateType);
+	middle_id_t addDelayGate(unsigned int delayTicks);
+	void connect(middle_id_t source, middle_id_t destination);
+	void endEdit();
+	// runs nTicks and returns once the last of them is done
+	void tick(unsigned int nTicks);
+	void setState(middle_id_t gateId, logic_state_t state);
+	logic_state_t getState(middle_id_t gateId) const;
+
+	std::unique_ptr<EvalConfig> evalConfig;
+	IdProvider<middle_id_t> middleIdProvider;
+	std::vector<simulator_id_t> dirtySimulatorIds;
+	std::unique_ptr<EvalSimulator> evalSimulator;
+};
+
+#endif /* evalSimulatorTest_h */
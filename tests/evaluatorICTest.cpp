@@ -41,6 +41,35 @@ circuit_id_t EvaluatorICTest::createPassThroughIC(const std::string& name) {
     return childId;
 }
 
+circuit_id_t EvaluatorICTest::createInverterIC(const std::string& name) {
+    // input junction feeding a NOR, so the instances have internal gates and connections
+    circuit_id_t childId = backend.createCircuit(name);
+    SharedCircuit child = backend.getCircuit(childId);
+
+    child->tryInsertBlock(Position(0, 0), Rotation::ZERO, BlockType::JUNCTION);
+    child->tryInsertBlock(Position(1, 0), Rotation::ZERO, BlockType::NOR);
+    child->tryCreateConnection(Position(0, 0), Position(1, 0));
+
+    CircuitManager& cm = backend.getCircuitManager();
+    BlockType icType = cm.setupBlockData(childId);
+
+    BlockData* bd = cm.getBlockDataManager()->getBlockData(icType);
+    bd->setDefaultData(false);
+    bd->setPrimitive(false);
+    bd->setPath("Custom");
+    bd->setSize(Size(2, 1));
+
+    bd->setConnectionInput(Vector(0, 0), 0);
+    bd->setConnectionOutput(Vector(1, 0), 1);
+
+    CircuitBlockData* cbd = cm.getCircuitBlockDataManager()->getCircuitBlockData(childId);
+
+    cbd->setConnectionIdPosition(0, Position(0, 0));
+    cbd->setConnectionIdPosition(1, Position(1, 0));
+
+    return childId;
+}
+
 TEST_F(EvaluatorICTest, SingleIC_PropagatesSignal) {
     const circuit_id_t icId = createPassThroughIC("PassThrough");
     const BlockType icBlockType = getICBlockType(icId);
@@ -145,4 +174,137 @@ TEST_F(EvaluatorICTest, SingleIC_MoveIOAndPropagatesSignal) {
 
     evaluator->setState(Address(pSwitch), logic_state_t::LOW);
     EXPECT_EQ(evaluator->getState(Address(pLight)), logic_state_t::LOW);
-}
\ No newline at end of file
+}
+
+TEST_F(EvaluatorICTest, SharedICInstances_EvaluateIndependently) {
+    const BlockType icType = getICBlockType(createInverterIC("Inverter"));
+
+    for (bool instancing : { true, false }) {
+        evaluator->setICInstancing(instancing);
+        const int row = instancing ? 0 : 10;
+        std::vector<std::pair<Position, Position>> instances;
+        for (int i = 0; i < 4; ++i) {
+            const Position pSwitch(i * 4, row);
+            const Position pIC(i * 4 + 1, row);
+            const Position pLight(i * 4 + 3, row);
+            ASSERT_TRUE(parentCircuit->tryInsertBlock(pSwitch, Rotation::ZERO, BlockType::SWITCH));
+            ASSERT_TRUE(parentCircuit->tryInsertBlock(pIC, Rotation::ZERO, icType));
+            ASSERT_TRUE(parentCircuit->tryInsertBlock(pLight, Rotation::ZERO, BlockType::LIGHT));
+            ASSERT_TRUE(parentCircuit->tryCreateConnection(pSwitch, pIC));
+            ASSERT_TRUE(parentCircuit->tryCreateConnection(pIC + Vector(1, 0), pLight));
+            instances.push_back({ pSwitch, pLight });
+        }
+
+        for (unsigned int i = 0; i < instances.size(); ++i) {
+            evaluator->setState(Address(instances[i].first), (i % 2) == 1 ? logic_state_t::HIGH : logic_state_t::LOW);
+        }
+        evaluator->tickStep(4);
+        for (unsigned int i = 0; i < instances.size(); ++i) {
+            EXPECT_EQ(evaluator->getState(Address(instances[i].second)), (i % 2) == 1 ? logic_state_t::LOW : logic_state_t::HIGH);
+        }
+    }
+}
+
+
+TEST_F(EvaluatorICTest, EvaluatorBuiltFromCircuitWithICs) {
+    // the ICs are placed before the evaluator exists, so they are all created while loading
+    const BlockType inverterType = getICBlockType(createInverterIC("Inverter"));
+    const BlockType passThroughType = getICBlockType(createPassThroughIC("PassThrough"));
+
+    circuit_id_t loadedId = backend.createCircuit("Loaded");
+    SharedCircuit loaded = backend.getCircuit(loadedId);
+    std::vector<std::tuple<Position, Position, bool>> instances;
+    for (int i = 0; i < 8; ++i) {
+        const bool inverting = (i % 2) == 0;
+        const Position pSwitch(0, i);
+        const Position pIC(1, i);
+        const Position pLight(4, i);
+        ASSERT_TRUE(loaded->tryInsertBlock(pSwitch, Rotation::ZERO, BlockType::SWITCH));
+        ASSERT_TRUE(loaded->tryInsertBlock(pIC, Rotation::ZERO, inverting ? inverterType : passThroughType));
+        ASSERT_TRUE(loaded->tryInsertBlock(pLight, Rotation::ZERO, BlockType::LIGHT));
+        ASSERT_TRUE(loaded->tryCreateConnection(pSwitch, pIC));
+        ASSERT_TRUE(loaded->tryCreateConnection(inverting ? pIC + Vector(1, 0) : pIC, pLight));
+        instances.push_back({ pSwitch, pLight, inverting });
+    }
+
+    auto evalId = backend.createEvaluator(loadedId);
+    ASSERT_TRUE(evalId.has_value());
+    SharedEvaluator loadedEvaluator = backend.getEvaluator(evalId.value());
+
+    for (const auto& [pSwitch, pLight, inverting] : instances) {
+        loadedEvaluator->setState(Address(pSwitch), logic_state_t::HIGH);
+    }
+    loadedEvaluator->tickStep(4);
+    for (const auto& [pSwitch, pLight, inverting] : instances) {
+        EXPECT_EQ(loadedEvaluator->getState(Address(pLight)), inverting ? logic_state_t::LOW : logic_state_t::HIGH);
+    }
+}
+
+TEST_F(EvaluatorICTest, EditedICDefinition_NotReusedFromCache) {
+    const circuit_id_t icId = createInverterIC("Inverter");
+    const BlockType icType = getICBlockType(icId);
+    SharedCircuit child = backend.getCircuit(icId);
+
+    const Position pSwitchA(0, 0), pICA(1, 0), pLightA(4, 0);
+    ASSERT_TRUE(parentCircuit->tryInsertBlock(pSwitchA, Rotation::ZERO, BlockType::SWITCH));
+    ASSERT_TRUE(parentCircuit->tryInsertBlock(pICA, Rotation::ZERO, icType));
+    ASSERT_TRUE(parentCircuit->tryInsertBlock(pLightA, Rotation::ZERO, BlockType::LIGHT));
+    ASSERT_TRUE(parentCircuit->tryCreateConnection(pSwitchA, pICA));
+    ASSERT_TRUE(parentCircuit->tryCreateConnection(pICA + Vector(1, 0), pLightA));
+
+    // turn the inverter into a buffer, the next instance has to be built from the edited circuit
+    ASSERT_TRUE(child->tryRemoveBlock(Position(1, 0)));
+    ASSERT_TRUE(child->tryInsertBlock(Position(1, 0), Rotation::ZERO, BlockType::OR));
+    ASSERT_TRUE(child->tryCreateConnection(Position(0, 0), Position(1, 0)));
+
+    const Position pSwitchB(0, 2), pICB(1, 2), pLightB(4, 2);
+    ASSERT_TRUE(parentCircuit->tryInsertBlock(pSwitchB, Rotation::ZERO, BlockType::SWITCH));
+    ASSERT_TRUE(parentCircuit->tryInsertBlock(pICB, Rotation::ZERO, icType));
+    ASSERT_TRUE(parentCircuit->tryInsertBlock(pLightB, Rotation::ZERO, BlockType::LIGHT));
+    ASSERT_TRUE(parentCircuit->tryCreateConnection(pSwitchB, pICB));
+    ASSERT_TRUE(parentCircuit->tryCreateConnection(pICB + Vector(1, 0), pLightB));
+
+    evaluator->setState(Address(pSwitchA), logic_state_t::HIGH);
+    evaluator->setState(Address(pSwitchB), logic_state_t::HIGH);
+    evaluator->tickStep(4);
+    EXPECT_EQ(evaluator->getState(Address(pLightA)), logic_state_t::HIGH);
+    EXPECT_EQ(evaluator->getState(Address(pLightB)), logic_state_t::HIGH);
+}
+
+TEST_F(EvaluatorICTest, SharedLayout_ReusesReleasedSlots) {
+    SharedEvalCircuitLayout layout = std::make_shared<EvalCircuitLayout>();
+    EvalCircuit first(1, 0, 0, layout);
+    EvalCircuit second(2, 0, 0, layout);
+    first.setNode(Position(0, 0), CircuitNode::fromMiddle(1));
+    second.setNode(Position(0, 0), CircuitNode::fromMiddle(2));
+
+    // every instance gets the same moves, the emptied slots are reused instead of growing the layout
+    for (int x = 1; x <= 100; ++x) {
+        first.moveNode(Position(x - 1, 0), Position(x, 0));
+        second.moveNode(Position(x - 1, 0), Position(x, 0));
+    }
+    ASSERT_EQ(layout->getSlotCount(), 2);
+    ASSERT_EQ(first.getPosition(CircuitNode::fromMiddle(1)), Position(100, 0));
+    ASSERT_EQ(second.getNode(Position(100, 0)), CircuitNode::fromMiddle(2));
+
+    // a slot is kept while any instance still holds a node in it
+    first.removeNode(Position(100, 0));
+    first.setNode(Position(0, 5), CircuitNode::fromMiddle(3));
+    ASSERT_EQ(layout->getSlotCount(), 2);
+    ASSERT_EQ(second.getNode(Position(100, 0)), CircuitNode::fromMiddle(2));
+    ASSERT_FALSE(first.getNode(Position(100, 0)).has_value());
+
+    // a deleted instance lets go of its slots
+    {
+        EvalCircuit third(3, 0, 0, layout);
+        third.setNode(Position(7, 7), CircuitNode::fromMiddle(4));
+        ASSERT_EQ(layout->getSlotCount(), 3);
+    }
+    second.removeNode(Position(100, 0));
+    first.setNode(Position(1, 5), CircuitNode::fromMiddle(5));
+    first.setNode(Position(2, 5), CircuitNode::fromMiddle(6));
+    ASSERT_EQ(layout->getSlotCount(), 3);
+    int nodeCount = 0;
+    first.forEachNode([&](Position, const CircuitNode&) { ++nodeCount; });
+    ASSERT_EQ(nodeCount, 3);
+}
@@ -17,6 +17,7 @@ protected:
     int idx;
 
     circuit_id_t createPassThroughIC(const std::string& name);
+    circuit_id_t createInverterIC(const std::string& name);
     inline BlockType getICBlockType(circuit_id_t cid) {
         auto* cbdm = backend.getCircuitManager().getCircuitBlockDataManager();
         auto* cbd = cbdm->getCircuitBlockData(cid);
@@ -166,6 +166,29 @@ TEST_F(EvaluatorTest, ThreadSafetyAndPausing) {
 	evaluator->setPause(true);
 }
 
+void EvaluatorTest::buildNotChain(int length, bool placeBackToFront) {
+	chainSwitch = Position(0, 0);
+	circuit->tryInsertBlock(chainSwitch, Rotation::ZERO, BlockType::SWITCH);
+	chain.clear();
+	for (int j = 1; j <= length; ++j) {
+		chain.push_back(Position(j, 0));
+	}
+	for (int j = 0; j < length; ++j) {
+		circuit->tryInsertBlock(chain[placeBackToFront ? length - 1 - j : j], Rotation::ZERO, BlockType::NOR);
+	}
+	for (int j = 0; j < length; ++j) {
+		circuit->tryCreateConnection(j == 0 ? chainSwitch : chain[j - 1], chain[j]);
+	}
+}
+
+void EvaluatorTest::expectChainFollows(bool input, unsigned int ticks) {
+	evaluator->setState(Address(chainSwitch), input);
+	evaluator->tickStep(ticks);
+	for (size_t k = 0; k < chain.size(); ++k) {
+		ASSERT_EQ(evaluator->getBoolState(Address(chain[k])), (k % 2 == 0) ? !input : input) << "NOT " << k << " of the chain";
+	}
+}
+
 void EvaluatorTest::changeState(const Address& addr) {
 	for (int j = 0; j < 100; j++) {
 		evaluator->setState(addr, j % 2 == 0);
@@ -231,3 +254,464 @@ TEST_F(EvaluatorTest, EqualityCircuit) {
 		}
 	}
 }
+
+TEST_F(EvaluatorTest, EventDrivenEvaluation) {
+	evaluator->setEvaluationMode(EvaluationMode::EVENT_DRIVEN);
+	buildNotChain(4);
+	for (int j = 0; j < 4; ++j) {
+		expectChainFollows(j % 2 == 1, chain.size());
+	}
+}
+
+TEST_F(EvaluatorTest, LevelizedEvaluation) {
+	evaluator->setEvaluationMode(EvaluationMode::LEVELIZED);
+	buildNotChain(8);
+	// the whole chain settles in a single tick
+	for (int j = 0; j < 4; ++j) {
+		expectChainFollows(j % 2 == 1, 1);
+	}
+}
+
+TEST_F(EvaluatorTest, SimulatorLayoutOptimization) {
+	// placed back to front, so the simulator ids run against the signal flow
+	buildNotChain(6, true);
+	std::vector<simulator_id_t> ids = evaluator->getBlockSimulatorIds(Address(), chain);
+	for (size_t k = 1; k < chain.size(); ++k) {
+		ASSERT_LT(ids[k], ids[k - 1]);
+	}
+	evaluator->optimizeSimulatorLayout();
+	// renumbered in signal order, every NOT right behind the one driving it
+	ids = evaluator->getBlockSimulatorIds(Address(), chain);
+	for (size_t k = 1; k < chain.size(); ++k) {
+		ASSERT_EQ(ids[k], ids[k - 1] + 1);
+	}
+
+	for (int j = 0; j < 4; ++j) {
+		expectChainFollows(j % 2 == 1, chain.size());
+	}
+}
+
+TEST_F(EvaluatorTest, SimulatorIdCompaction) {
+	// fill the id range and free most of it again
+	for (int j = 0; j < 64; ++j) {
+		circuit->tryInsertBlock(Position(j, 5), Rotation::ZERO, BlockType::AND);
+	}
+	Position switchPos(0, 0);
+	Position notPos(1, 0);
+	circuit->tryInsertBlock(switchPos, Rotation::ZERO, BlockType::SWITCH);
+	circuit->tryInsertBlock(notPos, Rotation::ZERO, BlockType::NOR);
+	circuit->tryCreateConnection(switchPos, notPos);
+	for (int j = 0; j < 64; ++j) {
+		circuit->tryRemoveBlock(Position(j, 5));
+	}
+	evaluator->compactSimulatorIds();
+
+	for (int j = 0; j < 4; ++j) {
+		bool input = (j % 2) == 1;
+		evaluator->setState(Address(switchPos), input);
+		evaluator->tickStep();
+		ASSERT_EQ(evaluator->getBoolState(Address(notPos)), !input);
+	}
+}
+
+TEST_F(EvaluatorTest, IncrementalJunctionMerging) {
+	Position switchPos(0, 0);
+	Position junctionA(1, 0);
+	Position junctionB(2, 0);
+	Position notA(3, 0);
+	circuit->tryInsertBlock(switchPos, Rotation::ZERO, BlockType::SWITCH);
+	circuit->tryInsertBlock(junctionA, Rotation::ZERO, BlockType::JUNCTION);
+	circuit->tryInsertBlock(junctionB, Rotation::ZERO, BlockType::JUNCTION);
+	circuit->tryInsertBlock(notA, Rotation::ZERO, BlockType::NOR);
+	circuit->tryCreateConnection(switchPos, junctionA);
+	circuit->tryCreateConnection(junctionA, junctionB);
+	circuit->tryCreateConnection(junctionB, notA);
+
+	// grow the merged group one edit at a time, then split it again
+	Position junctionC(4, 0);
+	Position notB(5, 0);
+	circuit->tryInsertBlock(junctionC, Rotation::ZERO, BlockType::JUNCTION);
+	circuit->tryInsertBlock(notB, Rotation::ZERO, BlockType::NOR);
+	circuit->tryCreateConnection(junctionB, junctionC);
+	circuit->tryCreateConnection(junctionC, notB);
+	for (int j = 0; j < 4; ++j) {
+		bool input = (j % 2) == 1;
+		evaluator->setState(Address(switchPos), input);
+		evaluator->tickStep(4);
+		ASSERT_EQ(evaluator->getBoolState(Address(notA)), !input);
+		ASSERT_EQ(evaluator->getBoolState(Address(notB)), !input);
+	}
+
+	circuit->tryRemoveConnection(junctionB, junctionC);
+	circuit->tryCreateConnection(switchPos, junctionC);
+	for (int j = 0; j < 4; ++j) {
+		bool input = (j % 2) == 1;
+		evaluator->setState(Address(switchPos), input);
+		evaluator->tickStep(4);
+		ASSERT_EQ(evaluator->getBoolState(Address(notA)), !input);
+		ASSERT_EQ(evaluator->getBoolState(Address(notB)), !input);
+	}
+}
+
+TEST_F(EvaluatorTest, BatchedEdits) {
+	evaluator->beginEditBatch();
+	buildNotChain(4);
+	// nested batches are applied by the outermost commit
+	evaluator->beginEditBatch();
+	circuit->tryRemoveConnection(chain[2], chain[3]);
+	circuit->tryCreateConnection(chain[1], chain[3]);
+	evaluator->commitEditBatch();
+	evaluator->commitEditBatch();
+
+	for (int j = 0; j < 4; ++j) {
+		bool input = (j % 2) == 1;
+		evaluator->setState(Address(chainSwitch), input);
+		evaluator->tickStep(chain.size());
+		ASSERT_EQ(evaluator->getBoolState(Address(chain[0])), !input);
+		ASSERT_EQ(evaluator->getBoolState(Address(chain[1])), input);
+		ASSERT_EQ(evaluator->getBoolState(Address(chain[2])), !input);
+		ASSERT_EQ(evaluator->getBoolState(Address(chain[3])), !input);
+	}
+}
+
+TEST_F(EvaluatorTest, ConstantFolding) {
+	evaluator->setConstantFolding(true);
+	Position constantPos(0, 0);
+	Position switchPos(0, 1);
+	Position notA(1, 0);
+	Position notB(2, 0);
+	Position output(3, 0);
+	circuit->tryInsertBlock(constantPos, Rotation::ZERO, BlockType::CONSTANT);
+	circuit->tryInsertBlock(switchPos, Rotation::ZERO, BlockType::SWITCH);
+	circuit->tryInsertBlock(notA, Rotation::ZERO, BlockType::NOR);
+	circuit->tryInsertBlock(notB, Rotation::ZERO, BlockType::NOR);
+	circuit->tryInsertBlock(output, Rotation::ZERO, BlockType::AND);
+	circuit->tryCreateConnection(constantPos, notA);
+	circuit->tryCreateConnection(notA, notB);
+	circuit->tryCreateConnection(notB, output);
+	circuit->tryCreateConnection(switchPos, output);
+	for (int j = 0; j < 4; ++j) {
+		bool input = (j % 2) == 1;
+		evaluator->setState(Address(switchPos), input);
+		evaluator->tickStep(4);
+		ASSERT_FALSE(evaluator->getBoolState(Address(notA)));
+		ASSERT_TRUE(evaluator->getBoolState(Address(notB)));
+		ASSERT_EQ(evaluator->getBoolState(Address(output)), input);
+	}
+
+	// feeding the folded chain from the switch has to undo both folds
+	circuit->tryRemoveConnection(constantPos, notA);
+	circuit->tryCreateConnection(switchPos, notA);
+	for (int j = 0; j < 4; ++j) {
+		bool input = (j % 2) == 1;
+		evaluator->setState(Address(switchPos), input);
+		evaluator->tickStep(4);
+		ASSERT_EQ(evaluator->getBoolState(Address(notA)), !input);
+		ASSERT_EQ(evaluator->getBoolState(Address(notB)), input);
+		ASSERT_EQ(evaluator->getBoolState(Address(output)), input);
+	}
+
+	circuit->tryRemoveConnection(switchPos, notA);
+	circuit->tryCreateConnection(constantPos, notA);
+	for (int j = 0; j < 4; ++j) {
+		bool input = (j % 2) == 1;
+		evaluator->setState(Address(switchPos), input);
+		evaluator->tickStep(4);
+		ASSERT_FALSE(evaluator->getBoolState(Address(notA)));
+		ASSERT_TRUE(evaluator->getBoolState(Address(notB)));
+		ASSERT_EQ(evaluator->getBoolState(Address(output)), input);
+	}
+}
+
+TEST_F(EvaluatorTest, DuplicateGateMerging) {
+	evaluator->setGateMerging(true);
+	Position switchA(0, 0);
+	Position switchB(0, 1);
+	Position andA(1, 0);
+	Position andB(1, 1);
+	Position notA(2, 0);
+	Position notB(2, 1);
+	circuit->tryInsertBlock(switchA, Rotation::ZERO, BlockType::SWITCH);
+	circuit->tryInsertBlock(switchB, Rotation::ZERO, BlockType::SWITCH);
+	circuit->tryInsertBlock(andA, Rotation::ZERO, BlockType::AND);
+	circuit->tryInsertBlock(andB, Rotation::ZERO, BlockType::AND);
+	circuit->tryInsertBlock(notA, Rotation::ZERO, BlockType::NOR);
+	circuit->tryInsertBlock(notB, Rotation::ZERO, BlockType::NOR);
+	circuit->tryCreateConnection(switchA, andA);
+	circuit->tryCreateConnection(switchB, andA);
+	circuit->tryCreateConnection(switchB, andB);
+	circuit->tryCreateConnection(switchA, andB);
+	circuit->tryCreateConnection(andA, notA);
+	circuit->tryCreateConnection(andB, notB);
+
+	// the duplicate ANDs share one simulated gate, which makes the NORs duplicates too
+	std::vector<simulator_id_t> simIds = evaluator->getBlockSimulatorIds(Address(), { andA, andB, notA, notB });
+	ASSERT_EQ(simIds[0], simIds[1]);
+	ASSERT_EQ(simIds[2], simIds[3]);
+	for (int j = 0; j < 4; ++j) {
+		evaluator->setState(Address(switchA), (j & 1) == 1);
+		evaluator->setState(Address(switchB), (j & 2) == 2);
+		evaluator->tickStep(3);
+		bool both = j == 3;
+		ASSERT_EQ(evaluator->getBoolState(Address(andA)), both);
+		ASSERT_EQ(evaluator->getBoolState(Address(andB)), both);
+		ASSERT_EQ(evaluator->getBoolState(Address(notA)), !both);
+		ASSERT_EQ(evaluator->getBoolState(Address(notB)), !both);
+	}
+
+	// once their inputs differ the gates are simulated separately again
+	circuit->tryRemoveConnection(switchB, andB);
+	simIds = evaluator->getBlockSimulatorIds(Address(), { andA, andB, notA, notB });
+	ASSERT_NE(simIds[0], simIds[1]);
+	ASSERT_NE(simIds[2], simIds[3]);
+	for (int j = 0; j < 4; ++j) {
+		evaluator->setState(Address(switchA), (j & 1) == 1);
+		evaluator->setState(Address(switchB), (j & 2) == 2);
+		evaluator->tickStep(3);
+		ASSERT_EQ(evaluator->getBoolState(Address(andA)), j == 3);
+		ASSERT_EQ(evaluator->getBoolState(Address(andB)), (j & 1) == 1);
+		ASSERT_EQ(evaluator->getBoolState(Address(notA)), j != 3);
+		ASSERT_EQ(evaluator->getBoolState(Address(notB)), (j & 1) == 0);
+	}
+}
+
+TEST_F(EvaluatorTest, BatchedSimulation) {
+	Position switchA(0, 0);
+	Position switchB(0, 1);
+	Position andGate(1, 0);
+	Position xorGate(1, 1);
+	Position norGate(2, 0);
+	circuit->tryInsertBlock(switchA, Rotation::ZERO, BlockType::SWITCH);
+	circuit->tryInsertBlock(switchB, Rotation::ZERO, BlockType::SWITCH);
+	circuit->tryInsertBlock(andGate, Rotation::ZERO, BlockType::AND);
+	circuit->tryInsertBlock(xorGate, Rotation::ZERO, BlockType::XOR);
+	circuit->tryInsertBlock(norGate, Rotation::ZERO, BlockType::NOR);
+	circuit->tryCreateConnection(switchA, andGate);
+	circuit->tryCreateConnection(switchB, andGate);
+	circuit->tryCreateConnection(switchA, xorGate);
+	circuit->tryCreateConnection(switchB, xorGate);
+	circuit->tryCreateConnection(andGate, norGate);
+	circuit->tryCreateConnection(xorGate, norGate);
+
+	std::vector<simulator_id_t> simIds = evaluator->getBlockSimulatorIds(Address(), { switchA, switchB, andGate, xorGate, norGate });
+	// more lanes than fit in two words, so the last word is only partly used
+	const unsigned int laneCount = 150;
+	BatchedSimulator batch = evaluator->makeBatchedSimulator(laneCount);
+	ASSERT_EQ(batch.getLaneCount(), laneCount);
+	for (unsigned int lane = 0; lane < laneCount; ++lane) {
+		batch.setState(lane, simIds[0], (lane & 1) == 1);
+		batch.setState(lane, simIds[1], (lane & 2) == 2);
+	}
+	batch.tick(3);
+	for (unsigned int lane = 0; lane < laneCount; ++lane) {
+		bool a = (lane & 1) == 1;
+		bool b = (lane & 2) == 2;
+		std::vector<logic_state_t> states = batch.getStates(lane, simIds);
+		ASSERT_EQ(states[2], fromBool(a && b));
+		ASSERT_EQ(states[3], fromBool(a != b));
+		ASSERT_EQ(states[4], fromBool(!a && !b));
+	}
+
+	// the batch runs on its own copy of the states
+	evaluator->tickStep(3);
+	ASSERT_FALSE(evaluator->getBoolState(Address(andGate)));
+	ASSERT_FALSE(evaluator->getBoolState(Address(xorGate)));
+	ASSERT_TRUE(evaluator->getBoolState(Address(norGate)));
+}
+
+TEST_F(EvaluatorTest, SimulatorSnapshot) {
+	Position switchA(0, 0);
+	Position switchB(0, 1);
+	Position andGate(1, 0);
+	circuit->tryInsertBlock(switchA, Rotation::ZERO, BlockType::SWITCH);
+	circuit->tryInsertBlock(switchB, Rotation::ZERO, BlockType::SWITCH);
+	circuit->tryInsertBlock(andGate, Rotation::ZERO, BlockType::AND);
+	circuit->tryCreateConnection(switchA, andGate);
+	circuit->tryCreateConnection(switchB, andGate);
+
+	evaluator->setState(Address(switchA), true);
+	evaluator->setState(Address(switchB), true);
+	evaluator->tickStep(2);
+	ASSERT_TRUE(evaluator->getBoolState(Address(andGate)));
+	SimulatorSnapshot snapshot = evaluator->takeSnapshot();
+	ASSERT_TRUE(snapshot.isValid());
+
+	evaluator->setState(Address(switchB), false);
+	evaluator->tickStep(2);
+	ASSERT_FALSE(evaluator->getBoolState(Address(andGate)));
+	ASSERT_TRUE(evaluator->restoreSnapshot(snapshot));
+	ASSERT_TRUE(evaluator->getBoolState(Address(switchB)));
+	ASSERT_TRUE(evaluator->getBoolState(Address(andGate)));
+
+	// a snapshot survives a round trip through a file
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "simulatorSnapshotTest.cmsnap";
+	ASSERT_TRUE(snapshot.save(path));
+	evaluator->reset();
+	ASSERT_FALSE(evaluator->getBoolState(Address(switchA)));
+	ASSERT_FALSE(evaluator->getBoolState(Address(andGate)));
+	std::optional<SimulatorSnapshot> loaded = SimulatorSnapshot::load(path);
+	std::filesystem::remove(path);
+	ASSERT_TRUE(loaded.has_value());
+	ASSERT_TRUE(evaluator->restoreSnapshot(loaded.value()));
+	ASSERT_TRUE(evaluator->getBoolState(Address(switchA)));
+	ASSERT_TRUE(evaluator->getBoolState(Address(andGate)));
+
+	// once the circuit changes the old snapshot no longer fits
+	circuit->tryRemoveConnection(switchB, andGate);
+	ASSERT_FALSE(evaluator->restoreSnapshot(snapshot));
+}
+
+TEST_F(EvaluatorTest, StepBackHistory) {
+	Position switchA(0, 0);
+	Position notA(1, 0);
+	Position notB(2, 0);
+	circuit->tryInsertBlock(switchA, Rotation::ZERO, BlockType::SWITCH);
+	circuit->tryInsertBlock(notA, Rotation::ZERO, BlockType::NOR);
+	circuit->tryInsertBlock(notB, Rotation::ZERO, BlockType::NOR);
+	circuit->tryCreateConnection(switchA, notA);
+	circuit->tryCreateConnection(notA, notB);
+	evaluator->tickStep(3);
+
+	// stepping pauses the simulator, so the states are read after stepping
+	evaluator->setHistoryDepth(8);
+	ASSERT_EQ(evaluator->stepBack(1), 0);
+	evaluator->setState(Address(switchA), true);
+	evaluator->tickStep(2);
+
+	ASSERT_EQ(evaluator->stepBack(1), 1);
+	ASSERT_TRUE(evaluator->getBoolState(Address(switchA)));
+	ASSERT_FALSE(evaluator->getBoolState(Address(notA)));
+	ASSERT_FALSE(evaluator->getBoolState(Address(notB)));
+	// setting the switch is a step of its own, so stepping back over it turns the switch off again
+	ASSERT_EQ(evaluator->stepBack(5), 2);
+	ASSERT_FALSE(evaluator->getBoolState(Address(switchA)));
+	ASSERT_TRUE(evaluator->getBoolState(Address(notA)));
+	ASSERT_FALSE(evaluator->getBoolState(Address(notB)));
+
+	ASSERT_EQ(evaluator->stepForward(4), 3);
+	ASSERT_TRUE(evaluator->getBoolState(Address(switchA)));
+	ASSERT_FALSE(evaluator->getBoolState(Address(notA)));
+	ASSERT_TRUE(evaluator->getBoolState(Address(notB)));
+
+	// ticking after stepping back starts a new future
+	ASSERT_EQ(evaluator->stepBack(2), 2);
+	ASSERT_TRUE(evaluator->getBoolState(Address(switchA)));
+	ASSERT_TRUE(evaluator->getBoolState(Address(notA)));
+	evaluator->tickStep(1);
+	ASSERT_EQ(evaluator->stepForward(1), 0);
+	ASSERT_FALSE(evaluator->getBoolState(Address(notA)));
+	ASSERT_FALSE(evaluator->getBoolState(Address(notB)));
+	ASSERT_EQ(evaluator->stepBack(3), 2);
+	ASSERT_FALSE(evaluator->getBoolState(Address(switchA)));
+	ASSERT_TRUE(evaluator->getBoolState(Address(notA)));
+}
+
+// the values of every signal of a VCD file in the order they were written, by the name in its $var line
+static std::map<std::string, std::string> readVcdValues(const std::filesystem::path& path, bool& sawTick) {
+	std::ifstream file(path);
+	std::map<std::string, std::string> names;
+	std::map<std::string, std::string> values;
+	sawTick = false;
+	for (std::string line; std::getline(file, line);) {
+		std::istringstream words(line);
+		std::string keyword, type, width, identifier, name;
+		if (words >> keyword >> type >> width >> identifier >> name && keyword == "$var") {
+			names[identifier] = name;
+		} else if (line.starts_with("#")) {
+			sawTick = true;
+		} else if (!line.empty() && line[0] != '$') {
+			values[line.substr(1)].push_back(line[0]);
+		}
+	}
+	std::map<std::string, std::string> valuesByName;
+	for (const auto& [identifier, name] : names) {
+		valuesByName[name] = values[identifier];
+	}
+	return valuesByName;
+}
+
+TEST_F(EvaluatorTest, WaveformCapture) {
+	Position switchA(0, 0);
+	Position notA(1, 0);
+	circuit->tryInsertBlock(switchA, Rotation::ZERO, BlockType::SWITCH);
+	circuit->tryInsertBlock(notA, Rotation::ZERO, BlockType::NOR);
+	circuit->tryCreateConnection(switchA, notA);
+	evaluator->tickStep(2);
+
+	// the empty address is the whole circuit
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "evaluatorTestWaveform.vcd";
+	ASSERT_TRUE(evaluator->startWaveformCapture(path, { Address() }));
+	evaluator->tickStep(2);
+	evaluator->setState(Address(switchA), true);
+	evaluator->tickStep(2);
+	evaluator->stopWaveformCapture();
+
+	bool sawTick;
+	std::map<std::string, std::string> values = readVcdValues(path, sawTick);
+	std::filesystem::remove(path);
+
+	ASSERT_TRUE(sawTick);
+	ASSERT_EQ(values.size(), 2);
+	ASSERT_EQ(values["(0,0)"].back(), '1');
+	ASSERT_EQ(values["(1,0)"].back(), '0');
+}
+
+TEST_F(EvaluatorTest, WaveformCaptureFollowsEdits) {
+	Position switchA(0, 0);
+	Position notA(1, 0);
+	Position switchB(0, 2);
+	circuit->tryInsertBlock(switchA, Rotation::ZERO, BlockType::SWITCH);
+	circuit->tryInsertBlock(notA, Rotation::ZERO, BlockType::NOR);
+	circuit->tryCreateConnection(switchA, notA);
+	evaluator->tickStep(2);
+
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "evaluatorTestWaveformEdits.vcd";
+	ASSERT_TRUE(evaluator->startWaveformCapture(path, { Address(notA) }));
+	evaluator->tickStep(2);
+	// the new switch most likely takes the id of the removed NOR, the capture must not follow it
+	circuit->tryRemoveBlock(notA);
+	circuit->tryInsertBlock(switchB, Rotation::ZERO, BlockType::SWITCH);
+	evaluator->setState(Address(switchB), true);
+	evaluator->tickStep(2);
+	// a block placed at the watched position is recorded again
+	circuit->tryInsertBlock(notA, Rotation::ZERO, BlockType::NOR);
+	circuit->tryCreateConnection(switchA, notA);
+	evaluator->tickStep(2);
+	evaluator->stopWaveformCapture();
+
+	bool sawTick;
+	std::map<std::string, std::string> values = readVcdValues(path, sawTick);
+	std::filesystem::remove(path);
+
+	ASSERT_EQ(values.size(), 1);
+	ASSERT_EQ(values["(1,0)"], "1x1");
+}
+
+TEST_F(EvaluatorTest, StateChangeFeed) {
+	Position switchA(0, 0);
+	Position notA(1, 0);
+	Position switchB(0, 2);
+	circuit->tryInsertBlock(switchA, Rotation::ZERO, BlockType::SWITCH);
+	circuit->tryInsertBlock(notA, Rotation::ZERO, BlockType::NOR);
+	circuit->tryInsertBlock(switchB, Rotation::ZERO, BlockType::SWITCH);
+	circuit->tryCreateConnection(switchA, notA);
+	evaluator->tickStep(3);
+	std::vector<simulator_id_t> ids = evaluator->getBlockSimulatorIds(Address(), { switchA, notA, switchB });
+	const simulator_id_t maxId = *std::max_element(ids.begin(), ids.end());
+
+	// a new feed reports every id once
+	state_change_feed_id_t feed = evaluator->subscribeStateChanges();
+	ASSERT_GT(evaluator->takeChangedSimulatorIds(feed).size(), maxId);
+	ASSERT_TRUE(evaluator->takeChangedSimulatorIds(feed).empty());
+
+	// the changes of several ticks are merged until the next take
+	evaluator->setState(Address(switchA), true);
+	evaluator->tickStep(3);
+	ASSERT_EQ(evaluator->takeChangedSimulatorIds(feed), std::vector<simulator_id_t>({ ids[0], ids[1] }));
+	ASSERT_TRUE(evaluator->takeChangedSimulatorIds(feed).empty());
+
+	// a reset changes everything
+	evaluator->reset();
+	ASSERT_GT(evaluator->takeChangedSimulatorIds(feed).size(), maxId);
+	evaluator->unsubscribeStateChanges(feed);
+}
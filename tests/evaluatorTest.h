@@ -13,10 +13,16 @@ public:
 protected:
 	void SetUp() override;
 	void TearDown() override;
+	// a switch at chainSwitch driving length single input NORs (so NOTs) in a row, placed in order or back to front
+	void buildNotChain(int length, bool placeBackToFront = false);
+	// sets the switch of the chain, runs ticks and checks that the chain alternates from input
+	void expectChainFollows(bool input, unsigned int ticks);
 	Backend backend;
 	SharedCircuit circuit;
 	SharedEvaluator evaluator;
 	int i;
+	Position chainSwitch;
+	std::vector<Position> chain;
 };
 
 #endif /* evaulatorTests_h */